@@ -1,861 +1,2259 @@
-/*
-  Agentuino.cpp - An Arduino library for a lightweight SNMP Agent.
-  Copyright (C) 2010 Eric C. Gionet <lavco_eg@hotmail.com>
-  All rights reserved.
-  This library is free software; you can redistribute it and/or
-  modify it under the terms of the GNU Lesser General Public
-  License as published by the Free Software Foundation; either
-  version 2.1 of the License, or (at your option) any later version.
-  This library is distributed in the hope that it will be useful,
-  but WITHOUT ANY WARRANTY; without even the implied warranty of
-  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
-  Lesser General Public License for more details.
-  You should have received a copy of the GNU Lesser General Public
-  License along with this library; if not, write to the Free Software
-  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
-*/
-
-//
-// sketch_aug23a
-//
-
-#include "Agentuino.h"
-#include <avr/pgmspace.h>
-#include <Ethernet.h>
-#include <EthernetUdp.h>
-
-EthernetUDP Udp;
-
-/**
- * @brief Initialize API with default configurations.
- *	  get community name = "public"
- *	  set community name = "private"
- *	  trap community name = "public"
- *	  Port 161 (get/set)
- * 	  Port 162 (trap)
- *
- * @param useTraps - If TRUE, configure API to send Traps. Otherwise, API do not send trap.
- * @param nms - Array with NMS IPv4 address.
- * @return - The API status code.
- * @see SNMP_API_STAT_CODES.
- */ 
-SNMP_API_STAT_CODES AgentuinoClass::begin(bool useTraps, uint8_t nms[4])
-{
-	trapListSize = 0;
-
-	memcpy(NMS.data, nms, 4);
-	
-	_getCommName = "public";
-	_setCommName = "private";
-	_trapCommName = "public";
-
-	// init UDP socket
-	Udp.begin(SNMP_DEFAULT_PORT);
-	
-	//#ifndef COMPILE_TRAPS
-	//
-	if(useTraps)
-	{
-		trap_list = (TRAP *) malloc(sizeof(TRAP)*MAX_TRAPS);
-		if(trap_list == NULL)
-			return 	SNMP_API_STAT_MALLOC_ERR;
-	}
-	else
-	{
-		_trapCommName = NULL;
-		trap_list = NULL;
-	}
-
-	trapNum = -1;
-	trapListSize = MAX_TRAPS;
-	//#endif
-
-	return SNMP_API_STAT_SUCCESS;
-}
-
-/**
- * @brief Initialize API with specific configurations.
- *
- * @param getCommName - Pointer to string of get community name.
- * @param setCommName - Pointer to string of set community name.
- * @param trapCommName - Pointer to string of trap community name.
- * @param num - Number of traps used in agent. If 0, do not use traps.
- * @param nms - Array with NMS IPv4 address.
- * @param port - Port for send get/set packet.
- * @return - The API status code.
- * @see SNMP_API_STAT_CODES.
- */ 
-SNMP_API_STAT_CODES AgentuinoClass::begin(const char *getCommName, const char *setCommName,
-					  const char *trapCommName, size_t num,
-					  uint8_t nms[4], uint16_t port)
-{
-	memcpy(NMS.data, nms, 4);
-
-	// set community name set/get sizes
-	size_t _setSize = strlen(setCommName);
-	size_t _getSize = strlen(getCommName);
-	size_t _trapSize = strlen(trapCommName);
-
-	//
-	// validate get/set community name sizes
-	if ( _setSize > SNMP_MAX_NAME_LEN + 1 || _getSize > SNMP_MAX_NAME_LEN + 1 || _trapSize > SNMP_MAX_NAME_LEN + 1) {
-		return SNMP_API_STAT_NAME_TOO_BIG;
-	}
-	//
-	// set community names
-	strcpy(_getCommName, getCommName);
-	strcpy(_setCommName, setCommName);
-	
-	//#ifndef DO_NOT_COMPILE_TRAPS
-	if(num)
-	{
-		strcpy(_trapCommName, trapCommName);
-		trap_list = (TRAP *) malloc(sizeof(TRAP)*num);
-		if(trap_list == NULL)
-			return SNMP_API_STAT_MALLOC_ERR;
-	}
-	else
-	{
-		_trapCommName = NULL;
-		trap_list = NULL;
-	}
-
-	trapNum = -1;
-	trapListSize = num;
-	//#endif
-	//
-	// validate session port number
-	if ( port == NULL || port == 0 ) port = SNMP_DEFAULT_PORT;
-	//
-	// init UDP socket
-	Udp.begin(port);
-
-	return SNMP_API_STAT_SUCCESS;
-}
-
-/**
- * @brief Check if API has received any SNMP packet, then execute call back function.
- * @param void
- * @return void
- */ 
-void AgentuinoClass::listen(void)
-{
-	time_ticks = millis()/10;
-
-	// if bytes are available in receive buffer
-	// and pointer to a function (delegate function)
-	// isn't null, trigger the function
-	Udp.parsePacket();
-	if ( Udp.available() && _callback != NULL ) (*_callback)();
-}
-
-//#ifndef DO_NOT_COMPILE_TRAPS
-SNMP_API_STAT_CODES AgentuinoClass::mountTrapPdu(TRAP *trap, SNMP_PDU *pdu)
-{
-	uint8_t listSize = 0;
-	VAR_BIND_LIST *tmpList;
-
-	pdu->type = SNMP_PDU_TRAP;
-  	pdu->OID.fromString(trap->oid);
-  	pdu->trap_type = trap->trapType;//SNMP_TRAP_WARM_START;
-  	pdu->specific_trap = trap->specificTrap;
-  	pdu->time_ticks = time_ticks;
-	pdu->trap_data_size = 0;
-	pdu->trap_data = NULL;
-
-	tmpList = trap->varBindList;
-	//found the size of varBindList
-	while(tmpList != NULL)
-	{
-		char tmpOid[SNMP_MAX_OID_LEN];
-		SNMP_OID rawOID;
-
-		listSize += 6;
-		/*
-		listSize++;//type sequence
-		listSize++;//sequence length
-		listSize++;//type oid
-		listSize++;//oid length
-		listSize++;//data var type
-		listSize++;//data length
-		*/
-		
-		strcpy(tmpOid, tmpList->oid);
-		rawOID.fromString(tmpOid);
-
-		listSize += rawOID.size;
-
-		if(tmpList->type == SNMP_SYNTAX_COUNTER64)		//------------
-			listSize += 8;					//
-		else if(tmpList->type == SNMP_SYNTAX_OCTETS)		// var size
-			listSize += strlen((char *)tmpList->var);	//
-		else							//------------
-			listSize += 4;					
-
-		tmpList = tmpList->nextVar;
-	}
-
-	tmpList = trap->varBindList;
-	
-  	pdu->trap_data_size = listSize;
-	
-	if(listSize)
-		//allocate trap data
-		pdu->trap_data = (byte *) malloc(sizeof(byte)*listSize);
-/*	else
-		Serial.println(F("\n Varbind is NULL"));*/
-	
-	if(pdu->trap_data == NULL && listSize != 0)
-		return SNMP_API_STAT_MALLOC_ERR;
-	else
-	{	
-		uint8_t j = 0;
-		//-------encode variable bind
-		while(trap->varBindList != NULL) 
-		{
-			uint8_t varSize = 0;
-			char tmpOid[SNMP_MAX_OID_LEN];
-			SNMP_OID rawOID;
-			byte *var;
-
-			strcpy(tmpOid, trap->varBindList->oid);
-			rawOID.fromString(tmpOid);
-
-			if(trap->varBindList->type == SNMP_SYNTAX_COUNTER64)
-				varSize = 8;
-			else if(trap->varBindList->type == SNMP_SYNTAX_OCTETS)
-				varSize = strlen((char *)trap->varBindList->var);
-			else
-				varSize = 4;
-
-			pdu->trap_data[j++] = (byte) SNMP_SYNTAX_SEQUENCE;
-
-			pdu->trap_data[j++] = (byte) (4 + rawOID.size + varSize);
-
-			//--------encode oid
-			pdu->trap_data[j++] = SNMP_SYNTAX_OID;
-			pdu->trap_data[j++] = rawOID.size;
-			for(uint8_t l = 0; l < rawOID.size; l++)
-				pdu->trap_data[j++] = rawOID.data[l];
-
-			//-------encode var
-			pdu->trap_data[j++] = (byte) trap->varBindList->type;			
-			pdu->trap_data[j++] = varSize;
-			
-			var = (byte *) malloc(sizeof(byte)*varSize);
-			
-			if(var == NULL)
-				return SNMP_API_STAT_MALLOC_ERR;
-			
-			memcpy(var, trap->varBindList->var, varSize);
-			if(trap->varBindList->type == SNMP_SYNTAX_OCTETS)
-			{
-				for(uint8_t l = 0; l < varSize; l++)
-					pdu->trap_data[j++] = var[l];
-			}
-			else
-			{	
-				do{
-					varSize -= 1;
-					pdu->trap_data[j++] = var[varSize];
-				}while(varSize > 0);
-			}
-			free(var);
-
-			trap->varBindList = trap->varBindList->nextVar;
-		}
-		trap->varBindList = tmpList;
-	}
- 
- 	return SNMP_API_STAT_SUCCESS;
-}
-
-uint8_t AgentuinoClass::checkTrapList()
-{
-	if(trap_list == NULL || trapNum + 1 > trapListSize - 1)
-	{
-		Serial.println(F("\n\rerror installTrap(): trap_list is FULL or NULL!\n\r"));
-		return 1; //error
-	}
-
-	return 0;
-}
-
-/*
- * @brief Notice a Trap condition to API.
- * @param oid - Pointer to trap OID
- * @param trapType - The type of trap (coldStart, warmStart, enterprise ...)
- * @param specific - Number of specific trap
- * @param obj - Pointer for a variable to be monitored.
- * @param objType - The type of variable to be monitored.
- * @param rel_op - The relational operator to compare value of obj and base_measure
- * @see enum relational_op
- * @param base_measure - Variable to be compared
- * @param varBindList - Variable attached to trap.
- * @return 0 for success, 1 for error
- */ 
-uint8_t AgentuinoClass::installTrap (const char *oid, SNMP_TRAP_TYPES trapType, 
-				     uint16_t specific, void *obj, SNMP_SYNTAXES objType, 
- 				     enum relational_op rel_op, void *base_measure,
-				     VAR_BIND_LIST *varBindList)
-{
-	if(checkTrapList())
-		return 1; //error
-
-	trap_list[++trapNum].objType = objType;
-	trap_list[trapNum].trapType = trapType;
-	trap_list[trapNum].specificTrap = specific;
-	strcpy_P(trap_list[trapNum].oid, (PGM_P) oid);
-	trap_list[trapNum].object_var = obj;
-	trap_list[trapNum].condition  = rel_op;
-	trap_list[trapNum].base_measure = base_measure;
-	trap_list[trapNum].send = false;
-	trap_list[trapNum].varBindList = varBindList;
-	
-	return 0;
-}
-
-/*
- * @brief Notice a Trap condition to API.
- * @param oid - Pointer to a not null trap struct.
- * @return 0 for success, 1 for error
- */ 
-
-uint8_t AgentuinoClass::installTrap(TRAP *trap)
-{
-	if(checkTrapList())
-		return 1; //error
-
-	trapNum++;
-
-	memcpy(trap_list + trapNum, trap, sizeof(TRAP));
-
-	return 0;
-}
-
-/*
- * @brief This function check if some condition in "trap_list" has been achieved. 
- * @params: void
- * @return: 255 if trap_list is null, otherwise return Number of conditions traps achieved.
-*/
-uint8_t AgentuinoClass::trapWatcher(void)
-{
-	uint8_t achievedTraps = 0;
-
-	//table_rel: basic relational operations
-	//----------------------------------------------------
-	//bit| 7 | 6 |   5  |  4  |   3  |   2  |   1  |  0  |
-	//====================================================
-	//val| 1 | 1 | a!=b | a==b | a>=b | a>b | a<=b | a<b |
-	//----------------------------------------------------
-	uint8_t table_rel;// = 0b11000000;
-
-	if(trapNum < 0)
-		return 255;
-
-	for(uint8_t i = 0; i <= trapNum; i++)
-	{
-		table_rel = 0b11000000;
-
-		switch(trap_list[i].objType)
-		{
-			case(SNMP_SYNTAX_UINT32):
-			case(SNMP_SYNTAX_INT):
-			case(SNMP_SYNTAX_COUNTER):
-			case(SNMP_SYNTAX_GAUGE):
-			case(SNMP_SYNTAX_TIME_TICKS):
-			{	
-				uint32_t a = *((uint32_t *) trap_list[i].object_var);
-				uint32_t b = *((uint32_t *) trap_list[i].base_measure);
-				
-				table_rel |= ((a!=b)<<NOT_EQUAL);
-				table_rel |= ((a==b)<<EQUAL);
-				table_rel |= ((a>=b)<<GREATER_OR_EQUAL);
-				table_rel |= ((a>b)<<GREATER_THAN);
-				table_rel |= ((a<=b)<<LESS_OR_EQUAL);
-				table_rel += (a<b);
-			}
-			break;
-			case(SNMP_SYNTAX_COUNTER64):
-			{
-				uint64_t a = *((uint64_t *) trap_list[i].object_var);
-				uint64_t b = *((uint64_t *) trap_list[i].base_measure);
-				
-				table_rel |= ((a!=b)<<NOT_EQUAL);
-				table_rel |= ((a==b)<<EQUAL);
-				table_rel |= ((a>=b)<<GREATER_OR_EQUAL);
-				table_rel |= ((a>b)<<GREATER_THAN);
-				table_rel |= ((a<=b)<<LESS_OR_EQUAL);
-				table_rel += (a<b);
-			}
-			break;
-		}
-		
-		trap_list[i].send = ((1<<trap_list[i].condition) & table_rel);
-
-		if(trap_list[i].send)
-		{
-			achievedTraps++;
-
-			SNMP_PDU pdu;
-			
-			if(mountTrapPdu(trap_list + i, &pdu))
-			{
-				Serial.println(F("mountTrapPdu error"));
-				return 255;
-			}
-
- 			if(Agentuino.sendTrap(&pdu, NMS.data) == SNMP_API_STAT_SUCCESS)
-				trap_list[i].send = false;
-			else
-			{
-				Serial.println(F("Trap not Send"));
-				return 255;
-			}
-		}
-	}
-
-	return achievedTraps;
-}
-
-SNMP_API_STAT_CODES AgentuinoClass::sendTrap(
-        SNMP_PDU *pdu, const uint8_t* manager)
-{
-	byte i;
-    	uint32_u ip;
-    	SNMP_VALUE value;
-
- 	uint16_t size = pdu->OID.size + 23; // + pdu->trap_data_size;
-	
-	//add bytes for variable-bindings
-	size += ((pdu->trap_data_size)?pdu->trap_data_size + 2 : 0);	
-
-	_packetPos = 0;
-
-    	_dstType = pdu->type;// = SNMP_PDU_TRAP;
-
-    	writeHeaders(pdu, size);
-
-    	_packet[_packetPos++] = (byte) size - 1;
-    	_packet[_packetPos++] = (byte) SNMP_SYNTAX_OID;
-	_packet[_packetPos++] = (byte) (pdu->OID.size);
-	
-	for(i = 0; i < pdu->OID.size; i++)
-		_packet[_packetPos++] = pdu->OID.data[i];
-
-   	_packet[_packetPos++] = (byte) SNMP_SYNTAX_IP_ADDRESS;
-   	_packet[_packetPos++] = (byte) 4;
-	
-	ip.uint32 = Ethernet.localIP();
-	pdu->address = ip.data;
-	
-	for(i = 0; i < 4; i++)
-		_packet[_packetPos++] = ip.data[i];
-	
-	_packet[_packetPos++] = (byte) SNMP_SYNTAX_INT;
-	
-	value.encode(SNMP_SYNTAX_INT, pdu->trap_type);
-	
-	_packet[_packetPos++] = (byte) sizeof(pdu->trap_type);
-	_packet[_packetPos++] = value.data[0];
-	_packet[_packetPos++] = value.data[1];
-	_packet[_packetPos++] = (byte) SNMP_SYNTAX_INT;
-	
-	value.encode(SNMP_SYNTAX_INT, pdu->specific_trap);
-	
-	_packet[_packetPos++] = (byte) sizeof(pdu->specific_trap);
-	_packet[_packetPos++] = value.data[0];
-	_packet[_packetPos++] = value.data[1];
-	_packet[_packetPos++] = (byte) SNMP_SYNTAX_TIME_TICKS;
-	_packet[_packetPos++] = (byte) sizeof(pdu->time_ticks);
-	
-	value.encode(SNMP_SYNTAX_TIME_TICKS, pdu->time_ticks);
-	
-	_packet[_packetPos++] = value.data[0];
-	_packet[_packetPos++] = value.data[1];
-	_packet[_packetPos++] = value.data[2];
-	_packet[_packetPos++] = value.data[3];
-
-	if(pdu->trap_data_size)
-	{
-    		_packet[_packetPos++] = (byte) SNMP_SYNTAX_SEQUENCE;
-    		_packet[_packetPos++] = (byte) pdu->trap_data_size;
-
-		for(i = 0; i < pdu->trap_data_size; i++)
-			_packet[_packetPos++] = *(pdu->trap_data + i);
-
-		free(pdu->trap_data);
-		pdu->trap_data = NULL;
-		
-	}
-
-    return writePacket(manager, 162);
-}
-
-//#endif
-
-SNMP_API_STAT_CODES AgentuinoClass::requestPdu(SNMP_PDU *pdu)
-{
-	char *community;
-	// sequence length
-	byte seqLen;
-	// version
-	byte verLen, verEnd;
-	// community string
-	byte comLen, comEnd;
-	// pdu
-	byte pduTyp, pduLen;
-	byte ridLen, ridEnd;
-	byte errLen, errEnd;
-	byte eriLen, eriEnd;
-	byte vblTyp, vblLen;
-	byte vbiTyp, vbiLen;
-	byte obiLen, obiEnd;
-	byte valTyp, valLen, valEnd;
-	byte i;
-
-	size_t _setSize = strlen(_setCommName);
-	size_t _getSize = strlen(_getCommName);
-	//size_t _trapSize = strlen(_trapCommName);
-	//
-	// set packet packet size (skip UDP header)
-	_packetSize = Udp.available();
-	//
-	// reset packet array
-	memset(_packet, 0, SNMP_MAX_PACKET_LEN);
-	//
-	// validate packet
-	if ( _packetSize != 0 && _packetSize > SNMP_MAX_PACKET_LEN ) {
-		//
-		//SNMP_FREE(_packet);
-
-		return SNMP_API_STAT_PACKET_TOO_BIG;
-	}
-	//
-	// get UDP packet
-	//Udp.parsePacket();
-	Udp.read(_packet, _packetSize);
-// 	Udp.readPacket(_packet, _packetSize, _dstIp, &_dstPort);
-	//
-	// packet check 1
-	if ( _packet[0] != 0x30 ) {
-		//
-		//SNMP_FREE(_packet);
-
-		return SNMP_API_STAT_PACKET_INVALID;
-	}
-	//
-	// sequence length
-	seqLen = _packet[1];
-	// version
-	verLen = _packet[3];
-	verEnd = 3 + verLen;
-	// community string
-	comLen = _packet[verEnd + 2];
-	comEnd = verEnd + 2 + comLen;
-	// pdu
-	pduTyp = _packet[comEnd + 1];
-	pduLen = _packet[comEnd + 2];
-	ridLen = _packet[comEnd + 4];
-	ridEnd = comEnd + 4 + ridLen;
-	errLen = _packet[ridEnd + 2];
-	errEnd = ridEnd + 2 + errLen;
-	eriLen = _packet[errEnd + 2];
-	eriEnd = errEnd + 2 + eriLen;
-	vblTyp = _packet[eriEnd + 1];
-	vblLen = _packet[eriEnd + 2];
-	vbiTyp = _packet[eriEnd + 3];
-	vbiLen = _packet[eriEnd + 4];
-	obiLen = _packet[eriEnd + 6];
-	obiEnd = eriEnd + obiLen + 6;
-	valTyp = _packet[obiEnd + 1];
-	valLen = _packet[obiEnd + 2];
-	valEnd = obiEnd + 2 + valLen;
-	//
-	// extract version
-	pdu->version = 0;
-	for ( i = 0; i < verLen; i++ ) {
-		pdu->version = (pdu->version << 8) | _packet[5 + i];
-	}
-	//
-	// validate version
-	//
-	// pdu-type
-	pdu->type = (SNMP_PDU_TYPES)pduTyp;
-	_dstType = pdu->type;
-	//
-	// validate community size
-	if ( comLen > SNMP_MAX_NAME_LEN ) {
-		// set pdu error
-		pdu->error = SNMP_ERR_TOO_BIG;
-		//
-		return SNMP_API_STAT_NAME_TOO_BIG;
-	}
-	//
-	//
-	// validate community name
-	if ( pdu->type == SNMP_PDU_SET && comLen == _setSize ) {
-		//
-		for ( i = 0; i < _setSize; i++ ) {
-			if( _packet[verEnd + 3 + i] != (byte)_setCommName[i] ) {
-				// set pdu error
-				pdu->error = SNMP_ERR_NO_SUCH_NAME;
-				//
-				return SNMP_API_STAT_NO_SUCH_NAME;
-			}
-		}
-	} else if ( pdu->type == SNMP_PDU_GET && comLen == _getSize ) {
-		//
-		for ( i = 0; i < _getSize; i++ ) {
-			if( _packet[verEnd + 3 + i] != (byte)_getCommName[i] ) {
-				// set pdu error
-				pdu->error = SNMP_ERR_NO_SUCH_NAME;
-				//
-				return SNMP_API_STAT_NO_SUCH_NAME;
-			}
-		}
-	} else if ( pdu->type == SNMP_PDU_GET_NEXT && comLen == _getSize ) {
-		//
-		for ( i = 0; i < _getSize; i++ ) {
-			if( _packet[verEnd + 3 + i] != (byte)_getCommName[i] ) {
-				// set pdu error
-				pdu->error = SNMP_ERR_NO_SUCH_NAME;
-				//
-				return SNMP_API_STAT_NO_SUCH_NAME;
-			}
-		}
-	} else {
-		// set pdu error
-		pdu->error = SNMP_ERR_NO_SUCH_NAME;
-		//
-		return SNMP_API_STAT_NO_SUCH_NAME;
-	}
-	//
-	//
-	// extract reqiest-id 0x00 0x00 0x00 0x01 (4-byte int aka int32)
-	pdu->requestId = 0;
-	for ( i = 0; i < ridLen; i++ ) {
-		pdu->requestId = (pdu->requestId << 8) | _packet[comEnd + 5 + i];
-	}
-	//
-	// extract error 
-	pdu->error = SNMP_ERR_NO_ERROR;
-	int32_t err = 0;
-	for ( i = 0; i < errLen; i++ ) {
-		err = (err << 8) | _packet[ridEnd + 3 + i];
-	}
-	pdu->error = (SNMP_ERR_CODES)err;
-	//
-	// extract error-index 
-	pdu->errorIndex = 0;
-	for ( i = 0; i < eriLen; i++ ) {
-		pdu->errorIndex = (pdu->errorIndex << 8) | _packet[errEnd + 3 + i];
-	}
-	//
-	//
-	// validate object-identifier size
-	if ( obiLen > SNMP_MAX_OID_LEN ) {
-		// set pdu error
-		pdu->error = SNMP_ERR_TOO_BIG;
-
-		return SNMP_API_STAT_OID_TOO_BIG;
-	}
-	//
-	// extract and contruct object-identifier
-	memset(pdu->OID.data, 0, SNMP_MAX_OID_LEN);
-	pdu->OID.size = obiLen;
-	for ( i = 0; i < obiLen; i++ ) {
-		pdu->OID.data[i] = _packet[eriEnd + 7 + i];
-	}
-	//
-	// value-type
-	pdu->VALUE.syntax = (SNMP_SYNTAXES)valTyp;
-	//
-	// validate value size
-	if ( obiLen > SNMP_MAX_VALUE_LEN ) {
-		// set pdu error
-		pdu->error = SNMP_ERR_TOO_BIG;
-
-		return SNMP_API_STAT_VALUE_TOO_BIG;
-	}
-	//
-	// value-size
-	pdu->VALUE.size = valLen;
-	//
-	// extract value
-	memset(pdu->VALUE.data, 0, SNMP_MAX_VALUE_LEN);
-	for ( i = 0; i < valLen; i++ ) {
-		pdu->VALUE.data[i] = _packet[obiEnd + 3 + i];
-	}
-	//
-	return SNMP_API_STAT_SUCCESS;
-}
-
-void AgentuinoClass::writeHeaders(SNMP_PDU *pdu, uint16_t size)
-{
-	int32_u u;
-	byte i;
-	
-	size_t _setSize = strlen(_setCommName);
-	size_t _getSize = strlen(_getCommName);
-	size_t _trapSize = 0;
-
-	if(_trapCommName != NULL)
-		_trapSize = strlen(_trapCommName);
-
-	//
-	// Length of entire SNMP packet
-	_packetPos = 0;  // 23
-	_packetSize = 8 + size;
-	//
-	memset(_packet, 0, SNMP_MAX_PACKET_LEN);
-	//
-	if ( _dstType == SNMP_PDU_SET ) {
-		_packetSize += _setSize;
-	} else {
-        	if ( _dstType == SNMP_PDU_TRAP ) {
-        	    _packetSize += _trapSize;
-        	} else {
-        	    _packetSize += _getSize;
-        	}
-    	}
-	//
-	_packet[_packetPos++] = (byte)SNMP_SYNTAX_SEQUENCE;	// type
-	_packet[_packetPos++] = (byte)_packetSize - 2;		// length
-	//
-	// SNMP version
-	_packet[_packetPos++] = (byte)SNMP_SYNTAX_INT;	// type
-	_packet[_packetPos++] = 0x01;			// length
-	_packet[_packetPos++] = 0x00;			// value
-	//
-	// SNMP community string
-	_packet[_packetPos++] = (byte)SNMP_SYNTAX_OCTETS;	// type
-	if ( _dstType == SNMP_PDU_SET ) {
-		_packet[_packetPos++] = (byte)_setSize;	// length
-		for ( i = 0; i < _setSize; i++ ) {
-			_packet[_packetPos++] = (byte)_setCommName[i];
-		}
-	} else {
-        if ( _dstType == SNMP_PDU_TRAP ) {
-            _packet[_packetPos++] = (byte)_trapSize;	// length
-            for ( i = 0; i < _getSize; i++ ) {
-                _packet[_packetPos++] = (byte)_trapCommName[i];
-            }
-        } else {
-            _packet[_packetPos++] = (byte)_getSize;	// length
-            for ( i = 0; i < _getSize; i++ ) {
-                _packet[_packetPos++] = (byte)_getCommName[i];
-            }
-        }
-	}
-	//
-	// SNMP PDU
-	_packet[_packetPos++] = (byte)pdu->type;
-}
-
-SNMP_API_STAT_CODES AgentuinoClass::responsePdu(SNMP_PDU *pdu)
-{
-	int32_u u;
-	byte i;
-    this->writeHeaders(pdu, 17 +
-            sizeof(pdu->requestId) + sizeof(pdu->error)
-            + sizeof(pdu->errorIndex) + pdu->OID.size
-            + pdu->VALUE.size);
-	_packet[_packetPos++] = (byte)( sizeof(pdu->requestId) + sizeof((int32_t)pdu->error) + sizeof(pdu->errorIndex) + pdu->OID.size + pdu->VALUE.size + 14 );
-	//
-	// Request ID (size always 4 e.g. 4-byte int)
-	_packet[_packetPos++] = (byte)SNMP_SYNTAX_INT;	// type
-	_packet[_packetPos++] = (byte)sizeof(pdu->requestId);
-	u.int32 = pdu->requestId;
-	_packet[_packetPos++] = u.data[3];
-	_packet[_packetPos++] = u.data[2];
-	_packet[_packetPos++] = u.data[1];
-	_packet[_packetPos++] = u.data[0];
-	//
-	// Error (size always 4 e.g. 4-byte int)
-	_packet[_packetPos++] = (byte)SNMP_SYNTAX_INT;	// type
-	_packet[_packetPos++] = (byte)sizeof((int32_t)pdu->error);
-	u.int32 = pdu->error;
-	_packet[_packetPos++] = u.data[3];
-	_packet[_packetPos++] = u.data[2];
-	_packet[_packetPos++] = u.data[1];
-	_packet[_packetPos++] = u.data[0];
-	//
-	// Error Index (size always 4 e.g. 4-byte int)
-	_packet[_packetPos++] = (byte)SNMP_SYNTAX_INT;	// type
-	_packet[_packetPos++] = (byte)sizeof(pdu->errorIndex);
-	u.int32 = pdu->errorIndex;
-	_packet[_packetPos++] = u.data[3];
-	_packet[_packetPos++] = u.data[2];
-	_packet[_packetPos++] = u.data[1];
-	_packet[_packetPos++] = u.data[0];
-	//
-	// Varbind List
-	_packet[_packetPos++] = (byte)SNMP_SYNTAX_SEQUENCE;	// type
-	_packet[_packetPos++] = (byte)( pdu->OID.size + pdu->VALUE.size + 6 ); //4
-	//
-	// Varbind
-	_packet[_packetPos++] = (byte)SNMP_SYNTAX_SEQUENCE;	// type
-	_packet[_packetPos++] = (byte)( pdu->OID.size + pdu->VALUE.size + 4 ); //2
-	//
-	// ObjectIdentifier
-	_packet[_packetPos++] = (byte)SNMP_SYNTAX_OID;	// type
-	_packet[_packetPos++] = (byte)(pdu->OID.size);
-	for ( i = 0; i < pdu->OID.size; i++ ) {
-		_packet[_packetPos++] = pdu->OID.data[i];
-	}
-	//
-	// Value
-	_packet[_packetPos++] = (byte)pdu->VALUE.syntax;	// type
-	_packet[_packetPos++] = (byte)(pdu->VALUE.size);
-	for ( i = 0; i < pdu->VALUE.size; i++ ) {
-		_packet[_packetPos++] = pdu->VALUE.data[i];
-	}
-    return writePacket(Udp.remoteIP(), Udp.remotePort());
-}
-
-SNMP_API_STAT_CODES AgentuinoClass::writePacket(
-        IPAddress address, uint16_t port)
-{
-	Udp.beginPacket(address, port);
-	Udp.write(_packet, _packetSize);
-	Udp.endPacket();
-	return SNMP_API_STAT_SUCCESS;
-}
-
-void AgentuinoClass::onPduReceive(onPduReceiveCallback pduReceived)
-{
-	_callback = pduReceived;
-}
-
-void AgentuinoClass::freePdu(SNMP_PDU *pdu)
-{
-	//
-	memset(pdu->OID.data, 0, SNMP_MAX_OID_LEN);
-	memset(pdu->VALUE.data, 0, SNMP_MAX_VALUE_LEN);
-	free((char *) pdu);
-}
-
-SNMP_API_STAT_CODES AgentuinoClass::addVarToBindList(VAR_BIND_LIST *bindList, 
-						    const char *oid, void *variable,
-						    SNMP_SYNTAXES type)
-{
-	VAR_BIND_LIST *newVar = (VAR_BIND_LIST *) malloc(sizeof(VAR_BIND_LIST));
-
-	if(newVar != NULL)
-	{
-		newVar->var = variable;
-		newVar->type = type;
-		strcpy_P(newVar->oid, (PGM_P) oid);
-		newVar->nextVar = bindList->nextVar;
-		bindList->nextVar = newVar;
-	}
-	else
-		return SNMP_API_STAT_MALLOC_ERR;
-	
-	return SNMP_API_STAT_SUCCESS;
-
-}
-// Create one global object
-AgentuinoClass Agentuino;
-
+/*
+  Agentuino.cpp - An Arduino library for a lightweight SNMP Agent.
+  Copyright (C) 2010 Eric C. Gionet <lavco_eg@hotmail.com>
+  All rights reserved.
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+//
+// sketch_aug23a
+//
+
+#include "Agentuino.h"
+#if defined(ARDUINO)
+#include <avr/pgmspace.h>
+#include "AgentuinoEthernet.h"
+#else
+#include "AgentuinoPosix.h"
+#include <stdio.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Create an agent. Every instance owns its transport, buffers, MIB,
+ *	  trap table and community names, so several agents (e.g. on
+ *	  different ports) can run side by side. Agentuino is the default one.
+ */ 
+AgentuinoClass::AgentuinoClass()
+{
+	trap_list = NULL;
+	trapListSize = 0;
+	trapNum = -1;
+	_getCommName[0] = '\0';
+	_setCommName[0] = '\0';
+	_trapCommName[0] = '\0';
+	_packetSize = 0;
+	_packetPos = 0;
+	_packetRead = false;
+	_callback = NULL;
+	_transport = NULL;
+	_ownTransport = false;
+	_registry = &_mib;
+}
+
+AgentuinoClass::~AgentuinoClass()
+{
+	clearTraps();
+#if SNMP_RESPONSE_CACHE_SIZE
+	for ( uint8_t i = 0; i < SNMP_RESPONSE_CACHE_SIZE; i++ ) {
+		SNMP_FREE(_responses[i].data);
+	}
+#endif
+#if SNMP_TRAP_QUEUE_SIZE
+	for ( uint8_t i = 0; i < SNMP_TRAP_QUEUE_SIZE; i++ ) {
+		SNMP_FREE(_trapQueue[i].data);
+	}
+#endif
+	for ( uint8_t i = 0; i < SNMP_MAX_INFORMS; i++ ) {
+		SNMP_FREE(_informs[i].data);
+	}
+	if ( _ownTransport ) {
+		delete _transport;
+	}
+}
+
+// opens the transport on port, creating the platform default one if none was set
+SNMP_API_STAT_CODES AgentuinoClass::openTransport(uint16_t port)
+{
+	if ( _transport == NULL ) {
+#if defined(ARDUINO)
+		_transport = new AgentuinoEthernet();
+#else
+		_transport = new AgentuinoPosix();
+#endif
+		if ( _transport == NULL ) {
+			return SNMP_API_STAT_MALLOC_ERR;
+		}
+		_ownTransport = true;
+	}
+	if ( _transport->begin(port) != SNMP_API_STAT_SUCCESS ) {
+		return SNMP_API_STAT_SOCKET_ERR;
+	}
+	return SNMP_API_STAT_SUCCESS;
+}
+
+/**
+ * @brief Initialize API with default configurations.
+ *	  get community name = "public"
+ *	  set community name = "private"
+ *	  trap community name = "public"
+ *	  Port 161 (get/set)
+ * 	  Port 162 (trap)
+ *
+ * @param useTraps - If TRUE, configure API to send Traps. Otherwise, API do not send trap.
+ * @param nms - Array with NMS IPv4 address.
+ * @return - The API status code.
+ * @see SNMP_API_STAT_CODES.
+ */ 
+SNMP_API_STAT_CODES AgentuinoClass::begin(bool useTraps, uint8_t nms[4])
+{
+	SNMP_API_STAT_CODES status;
+
+	trapListSize = 0;
+
+	memcpy(NMS.data, nms, 4);
+	
+	strcpy(_getCommName, "public");
+	strcpy(_setCommName, "private");
+	strcpy(_trapCommName, "public");
+
+	// init UDP socket
+	status = openTransport(SNMP_DEFAULT_PORT);
+	if ( status != SNMP_API_STAT_SUCCESS ) {
+		return status;
+	}
+	
+	//#ifndef COMPILE_TRAPS
+	//
+	clearTraps();
+	if(useTraps)
+	{
+		trap_list = (TRAP *) malloc(sizeof(TRAP)*MAX_TRAPS);
+		if(trap_list == NULL)
+			return 	SNMP_API_STAT_MALLOC_ERR;
+	}
+	else
+	{
+		_trapCommName[0] = '\0';
+	}
+
+	trapNum = -1;
+	trapListSize = MAX_TRAPS;
+	//#endif
+
+	return SNMP_API_STAT_SUCCESS;
+}
+
+/**
+ * @brief Initialize API with specific configurations.
+ *
+ * @param getCommName - Pointer to string of get community name.
+ * @param setCommName - Pointer to string of set community name.
+ * @param trapCommName - Pointer to string of trap community name.
+ * @param num - Number of traps used in agent. If 0, do not use traps.
+ * @param nms - Array with NMS IPv4 address.
+ * @param port - Port for send get/set packet.
+ * @return - The API status code.
+ * @see SNMP_API_STAT_CODES.
+ */ 
+SNMP_API_STAT_CODES AgentuinoClass::begin(const char *getCommName, const char *setCommName,
+					  const char *trapCommName, size_t num,
+					  uint8_t nms[4], uint16_t port)
+{
+	memcpy(NMS.data, nms, 4);
+
+	// set community name set/get sizes
+	size_t _setSize = strlen(setCommName);
+	size_t _getSize = strlen(getCommName);
+	size_t _trapSize = strlen(trapCommName);
+
+	//
+	// validate get/set community name sizes
+	if ( _setSize > SNMP_MAX_NAME_LEN || _getSize > SNMP_MAX_NAME_LEN || _trapSize > SNMP_MAX_NAME_LEN ) {
+		return SNMP_API_STAT_NAME_TOO_BIG;
+	}
+	//
+	// set community names
+	strcpy(_getCommName, getCommName);
+	strcpy(_setCommName, setCommName);
+	
+	//#ifndef DO_NOT_COMPILE_TRAPS
+	clearTraps();
+	if(num)
+	{
+		strcpy(_trapCommName, trapCommName);
+		trap_list = (TRAP *) malloc(sizeof(TRAP)*num);
+		if(trap_list == NULL)
+			return SNMP_API_STAT_MALLOC_ERR;
+	}
+	else
+	{
+		_trapCommName[0] = '\0';
+	}
+
+	trapNum = -1;
+	trapListSize = num;
+	//#endif
+	//
+	// validate session port number
+	if ( port == 0 ) port = SNMP_DEFAULT_PORT;
+	//
+	// init UDP socket
+	return openTransport(port);
+}
+
+/**
+ * @brief Check if API has received any SNMP packet, then execute call back function.
+ *	  Up to setListenBudget() datagrams are handled per call.
+ * @param void
+ * @return void
+ */ 
+void AgentuinoClass::listen(void)
+{
+	drain(_listenBudget);
+}
+
+/**
+ * @brief Handle every datagram already pending, without blocking. Meant for
+ *	  event loops that wait until fd() is readable instead of calling
+ *	  listen() all the time (see AgentuinoEventLoop on Linux).
+ * @param void
+ * @return - The number of datagrams handled.
+ */ 
+uint16_t AgentuinoClass::processReady(void)
+{
+	return drain(0xFFFF);
+}
+
+/**
+ * @brief Handle up to budget pending datagrams. Their responses may be
+ *	  queued by the transport and are flushed at the end, a flush that
+ *	  fails is counted in sendErrorCount().
+ * @return - The number of datagrams handled, 0 before begin() or
+ *	     setTransport().
+ */ 
+uint16_t AgentuinoClass::drain(uint16_t budget)
+{
+	uint16_t n;
+
+	time_ticks = millis()/10;
+	if ( _transport == NULL ) return 0;
+
+	_transport->beginBatch();
+	for ( n = 0; n < budget; n++ ) {
+		// if a datagram is pending in the transport
+		// and pointer to a function (delegate function)
+		// isn't null, trigger the function, otherwise
+		// answer from the MIB registry
+		_packetSize = _transport->parsePacket();
+		if ( _packetSize == 0 ) break;
+		_packetRead = false;
+		_requests++;
+		if ( ackInform() ) continue;
+		if ( replayResponse() ) continue;
+		if ( _callback != NULL ) (*_callback)();
+		else if ( _registry->count() ) dispatchPdu();
+	}
+	if ( _transport->flush() != SNMP_API_STAT_SUCCESS ) {
+		_sendErrors++;	// lost like UDP, the manager retries
+	}
+	return n;
+}
+
+/**
+ * @brief Answer the pending request from the MIB registry.
+ * @param void
+ * @return void
+ */ 
+void AgentuinoClass::dispatchPdu(void)
+{
+	SNMP_PDU pdu;
+	SNMP_API_STAT_CODES status = requestPdu(&pdu);
+
+	if ( status == SNMP_API_STAT_PACKET_TOO_BIG && pdu.error == SNMP_ERR_TOO_BIG ) {
+		// more variable bindings than SNMP_MAX_VARBINDS
+		pdu.type = SNMP_PDU_RESPONSE;
+		pdu.errorIndex = 0;
+		responsePdu(&pdu);
+		return;
+	}
+	if ( status != SNMP_API_STAT_SUCCESS ) return;
+	if ( pdu.type != SNMP_PDU_GET && pdu.type != SNMP_PDU_GET_NEXT
+		&& pdu.type != SNMP_PDU_SET && pdu.type != SNMP_PDU_GET_BULK ) return;
+	pdu.time_ticks = time_ticks;	// clock of the registry value cache
+	_registry->process(&pdu, varBindRoom());
+	if ( pdu.error != SNMP_ERR_NO_ERROR ) {
+		// an error response carries the request bindings unchanged
+		SNMP_ERR_CODES error = pdu.error;
+		int32_t errorIndex = pdu.errorIndex;
+
+		parsePdu(&pdu);
+		pdu.type = SNMP_PDU_RESPONSE;
+		pdu.error = error;
+		pdu.errorIndex = errorIndex;
+	}
+	responsePdu(&pdu);
+}
+
+/**
+ * @brief Bytes left for variable bindings in a response to the pending
+ *	  request, after the message and pdu headers.
+ * @param void
+ * @return - The room in bytes.
+ */ 
+uint16_t AgentuinoClass::varBindRoom(void)
+{
+	// message, pdu and list headers with the widest length SNMP_MAX_PACKET_LEN needs
+	uint16_t headers = 3 * (1 + snmpLengthSize(SNMP_MAX_PACKET_LEN)) + 3 + 2 + 18
+			 + strlen(_dstType == SNMP_PDU_SET ? _setCommName : _getCommName);
+
+	return SNMP_MAX_PACKET_LEN > headers ? SNMP_MAX_PACKET_LEN - headers : 0;
+}
+
+/**
+ * @brief Register a MIB object backed by a variable.
+ * @param oid - BER encoded OID, must stay valid while the agent runs.
+ * @param oidSize - Number of bytes in oid.
+ * @param syntax - Syntax of the object (selects how var is read/written).
+ * @param access - SNMP_ACCESS_READ_ONLY, SNMP_ACCESS_READ_WRITE or SNMP_ACCESS_STATIC.
+ * @param var - Pointer to the variable (char array for octet strings).
+ * @param varSize - Size of the char array for writable octet strings.
+ * @return - The API status code.
+ */ 
+SNMP_API_STAT_CODES AgentuinoClass::addObject(const byte *oid, size_t oidSize, SNMP_SYNTAXES syntax,
+					      SNMP_ACCESS_MODES access, void *var, size_t varSize)
+{
+	SNMP_OBJECT object;
+
+	memset(&object, 0, sizeof(object));
+	object.oid = oid;
+	object.oidSize = oidSize;
+	object.syntax = syntax;
+	object.access = access;
+	object.var = var;
+	object.varSize = varSize;
+	return _registry->add(&object);
+}
+
+/**
+ * @brief Register a MIB object served by callbacks.
+ * @param get - Fills the value with SNMP_VALUE::encode().
+ * @param set - Receives the request value, NULL for read-only objects.
+ * @return - The API status code.
+ */ 
+SNMP_API_STAT_CODES AgentuinoClass::addObject(const byte *oid, size_t oidSize, SNMP_SYNTAXES syntax,
+					      SNMP_ACCESS_MODES access, onGetCallback get, onSetCallback set)
+{
+	SNMP_OBJECT object;
+
+	memset(&object, 0, sizeof(object));
+	object.oid = oid;
+	object.oidSize = oidSize;
+	object.syntax = syntax;
+	object.access = access;
+	object.get = get;
+	object.set = set;
+	return _registry->add(&object);
+}
+
+/**
+ * @brief Answer requests from the registry of another agent. Objects are
+ *	  then added to owner; once several agents run in parallel, owner's
+ *	  registry must be frozen (AgentuinoMib::freeze()).
+ * @param owner - Agent holding the registry, must outlive this one.
+ * @return void
+ */ 
+void AgentuinoClass::shareMib(AgentuinoClass *owner)
+{
+	_registry = owner->_registry;
+}
+
+/**
+ * @brief Re-encode a SNMP_ACCESS_STATIC object on its next request. Call it
+ *	  whenever the variable behind such an object is changed.
+ * @param oid - BER encoded OID the object was registered with.
+ * @param oidSize - Number of bytes in oid.
+ * @return - The API status code.
+ */ 
+SNMP_API_STAT_CODES AgentuinoClass::invalidateObject(const byte *oid, size_t oidSize)
+{
+	return _registry->invalidate(oid, oidSize);
+}
+
+/**
+ * @brief Reuse the value of a slow object (I2C sensor, ADC average, ...) for
+ *	  a while instead of calling its getter on every request. The age is
+ *	  measured in the time_ticks listen() maintains; see AgentuinoMib::setTtl().
+ * @param oid - BER encoded OID the object was registered with.
+ * @param oidSize - Number of bytes in oid.
+ * @param ms - Time-to-live, rounded up to 10 ms; 0 turns the cache off.
+ * @return - The API status code.
+ */ 
+SNMP_API_STAT_CODES AgentuinoClass::setObjectTtl(const byte *oid, size_t oidSize, uint32_t ms)
+{
+	return _registry->setTtl(oid, oidSize, (ms + 9) / 10);
+}
+
+uint32_t AgentuinoClass::valueCacheHits(void)
+{
+	uint32_t hits, misses;
+
+	_registry->valueCacheStats(NULL, 0, &hits, &misses);
+	return hits;
+}
+
+uint32_t AgentuinoClass::valueCacheMisses(void)
+{
+	uint32_t hits, misses;
+
+	_registry->valueCacheStats(NULL, 0, &hits, &misses);
+	return misses;
+}
+
+/**
+ * @brief Register a handler for every OID below a prefix (longest prefix wins).
+ * @param oid - BER encoded prefix, must stay valid while the agent runs.
+ * @param oidSize - Number of bytes in oid.
+ * @param handler - Called with the sub-identifiers following the prefix.
+ * @param arg - Passed back to handler.
+ * @return - The API status code.
+ */ 
+SNMP_API_STAT_CODES AgentuinoClass::addSubtree(const byte *oid, size_t oidSize,
+					       onSubtreeCallback handler, void *arg)
+{
+	SNMP_SUBTREE subtree;
+
+	subtree.oid = oid;
+	subtree.oidSize = oidSize;
+	subtree.handler = handler;
+	subtree.arg = arg;
+	return _registry->addSubtree(&subtree);
+}
+
+/**
+ * @brief Register a conceptual table, it answers every column.index below oid.
+ * @param oid - BER encoded entry OID (e.g. ifEntry), must stay valid while the agent runs.
+ * @param oidSize - Number of bytes in oid.
+ * @param table - Table set up with begin(), must stay valid while the agent runs.
+ * @return - The API status code.
+ */ 
+SNMP_API_STAT_CODES AgentuinoClass::addTable(const byte *oid, size_t oidSize, AgentuinoTable *table)
+{
+	return addSubtree(oid, oidSize, AgentuinoTable::handler, table);
+}
+
+// encodes a trap variable binding list; it is singly linked, so later bindings are written first.
+// oids holds the BER OIDs installTrap() encoded for the bindings given as text, in list order.
+static void writeTrapVarBinds(SNMP_BER_WRITER *ber, const VAR_BIND_LIST *var, const byte *oids)
+{
+	const byte *berOid;
+	uint8_t berOidSize;
+	uint16_t mark;
+
+	if ( var == NULL ) return;
+	berOid = var->berOid;
+	berOidSize = var->berOidSize;
+	if ( var->var != NULL && berOid == NULL && oids != NULL ) {
+		berOidSize = oids[0];
+		berOid = oids + 1;
+		oids += 1 + berOidSize;
+	}
+	writeTrapVarBinds(ber, var->nextVar, oids);
+	if ( var->var == NULL ) return;		// list head, addVarToBindList() links behind it
+	mark = ber->size();
+	//
+	//-------encode var
+	if ( var->type == SNMP_SYNTAX_OCTETS ) {
+		ber->writeTLV(var->type, (const byte *) var->var, strlen((const char *) var->var));
+	} else if ( var->type == SNMP_SYNTAX_IP_ADDRESS ) {
+		ber->writeTLV(var->type, (const byte *) var->var, 4);
+	} else if ( var->type == SNMP_SYNTAX_COUNTER64 ) {
+		ber->writeInteger(var->type, *(const uint64_t *) var->var);
+	} else if ( var->type == SNMP_SYNTAX_INT ) {
+		ber->writeInteger(var->type, *(const int32_t *) var->var);
+	} else {
+		ber->writeInteger(var->type, *(const uint32_t *) var->var);
+	}
+	//--------encode oid, installTrap() and addVarToBindList() encoded every one
+	if ( berOid == NULL ) {
+		ber->overflow = true;	// nothing sensible to send
+		return;
+	}
+	ber->writeTLV(SNMP_SYNTAX_OID, berOid, berOidSize);
+	ber->close(SNMP_SYNTAX_SEQUENCE, mark);
+}
+
+// BER encodes a text OID into a malloc'ed buffer
+static SNMP_API_STAT_CODES encodeTextOid(const char *text, byte **oid, uint8_t *size)
+{
+	SNMP_OID rawOID;
+
+	if ( rawOID.fromString(text) != SNMP_ERR_NO_ERROR ) {
+		return SNMP_API_STAT_OID_INVALID;
+	}
+	*oid = (byte *) malloc(rawOID.size);
+	if ( *oid == NULL ) {
+		return SNMP_API_STAT_MALLOC_ERR;
+	}
+	memcpy(*oid, rawOID.data, rawOID.size);
+	*size = rawOID.size;
+	return SNMP_API_STAT_SUCCESS;
+}
+
+// encodes the text OIDs of a variable binding list once, so sending needs no conversion.
+// The list belongs to the caller and is left untouched: the BER forms go, each
+// behind its size byte and in list order, into one malloc'ed buffer the trap
+// entry owns (NULL when every binding already has a berOid).
+static SNMP_API_STAT_CODES encodeVarBindOids(const VAR_BIND_LIST *list, byte **oids)
+{
+	const VAR_BIND_LIST *var;
+	SNMP_OID rawOID;
+	uint16_t size = 0;
+	byte *pos;
+
+	*oids = NULL;
+	for ( var = list; var != NULL; var = var->nextVar ) {
+		if ( var->var != NULL && var->berOid == NULL ) {
+			if ( rawOID.fromString(var->oid) != SNMP_ERR_NO_ERROR ) {
+				return SNMP_API_STAT_OID_INVALID;
+			}
+			size += 1 + rawOID.size;
+		}
+	}
+	if ( size == 0 ) {
+		return SNMP_API_STAT_SUCCESS;
+	}
+	*oids = (byte *) malloc(size);
+	if ( *oids == NULL ) {
+		return SNMP_API_STAT_MALLOC_ERR;
+	}
+	pos = *oids;
+	for ( var = list; var != NULL; var = var->nextVar ) {
+		if ( var->var != NULL && var->berOid == NULL ) {
+			rawOID.fromString(var->oid);
+			*pos++ = rawOID.size;
+			memcpy(pos, rawOID.data, rawOID.size);
+			pos += rawOID.size;
+		}
+	}
+	return SNMP_API_STAT_SUCCESS;
+}
+
+//#ifndef DO_NOT_COMPILE_TRAPS
+// .iso.org.dod.internet.snmpV2.snmpModules.snmpMIB.snmpMIBObjects.snmpTrap.snmpTrapOID.0
+static const byte SNMP_TRAP_OID_0[] = { 0x2B, 6, 1, 6, 3, 1, 1, 4, 1, 0 };
+// .iso.org.dod.internet.snmpV2.snmpModules.snmpMIB.snmpMIBObjects.snmpTraps, generic traps
+static const byte SNMP_TRAPS[] = { 0x2B, 6, 1, 6, 3, 1, 1, 5 };
+// .iso.org.dod.internet.mgmt.mib-2.system.sysUpTime.0
+static const byte SNMP_SYS_UP_TIME_0[] = { 0x2B, 6, 1, 2, 1, 1, 3, 0 };
+
+// bytes of an OID sub-identifier in base 128
+static uint8_t subIdSize(uint32_t id)
+{
+	uint8_t n = 1;
+
+	while ( id >>= 7 ) n++;
+	return n;
+}
+
+/*
+ * @brief Encodes the parts of a trap that do not change between two sends:
+ *	  enterprise, agent-addr, generic and specific trap, and for v2
+ *	  notifications the snmpTrapOID.0 binding (RFC 3584 3.1). Done once
+ *	  at install, the only allocation a trap makes.
+ * @param trap - Entry of trap_list with berOid set.
+ * @return - The API status code.
+ */
+SNMP_API_STAT_CODES AgentuinoClass::buildTrapHeader(TRAP *trap)
+{
+	SNMP_BER_WRITER ber;
+	uint32_u ip;
+	uint16_t size, notifyOid, notify;
+
+	ip.uint32 = 0;
+	if(_transport != NULL)
+		_transport->localIP(ip.data);
+	size = 1 + snmpLengthSize(trap->berOidSize) + trap->berOidSize + 6
+	     + 2 + snmpIntegerSize((int32_t) trap->trapType)
+	     + 2 + snmpIntegerSize((int32_t) trap->specificTrap);
+	// snmpTraps.(generic + 1), or enterprise.0.specific
+	if(trap->trapType != SNMP_TRAP_ENTERPRISE_SPECIFIC)
+		notifyOid = sizeof(SNMP_TRAPS) + 1;
+	else
+		notifyOid = trap->berOidSize + 1 + subIdSize(trap->specificTrap);
+	notify = 2 + sizeof(SNMP_TRAP_OID_0) + 1 + snmpLengthSize(notifyOid) + notifyOid;
+	notify += 1 + snmpLengthSize(notify);
+	if(size > 0xFF || notify > 0xFF)
+		return SNMP_API_STAT_OID_TOO_BIG;
+	trap->header = (byte *) malloc(size + notify);
+	if(trap->header == NULL)
+		return SNMP_API_STAT_MALLOC_ERR;
+
+	ber.begin(trap->header, size + notify);
+	if(trap->trapType != SNMP_TRAP_ENTERPRISE_SPECIFIC)
+	{
+		ber.writeByte(trap->trapType + 1);
+		ber.writeBytes(SNMP_TRAPS, sizeof(SNMP_TRAPS));
+	}
+	else
+	{
+		for(uint32_t id = trap->specificTrap, last = 0; ; last = 0x80)
+		{
+			ber.writeByte((id & 0x7F) | last);
+			if(!(id >>= 7))
+				break;
+		}
+		ber.writeByte(0);
+		ber.writeBytes(trap->berOid, trap->berOidSize);
+	}
+	ber.writeHeader(SNMP_SYNTAX_OID, notifyOid);
+	ber.writeTLV(SNMP_SYNTAX_OID, SNMP_TRAP_OID_0, sizeof(SNMP_TRAP_OID_0));
+	ber.close(SNMP_SYNTAX_SEQUENCE, 0);
+
+	ber.writeInteger(SNMP_SYNTAX_INT, (int32_t) trap->specificTrap);
+	ber.writeInteger(SNMP_SYNTAX_INT, (int32_t) trap->trapType);
+	ber.writeTLV(SNMP_SYNTAX_IP_ADDRESS, ip.data, 4);
+	ber.writeTLV(SNMP_SYNTAX_OID, trap->berOid, trap->berOidSize);
+	trap->headerSize = size;
+	trap->notifySize = notify;
+	trap->addrPos = 1 + snmpLengthSize(trap->berOidSize) + trap->berOidSize + 2;
+
+	return SNMP_API_STAT_SUCCESS;
+}
+
+/*
+ * @brief Encodes the contents of a trap PDU into _packet from its header,
+ *	  without allocations or OID conversion. Only the bindings, the time
+ *	  stamp and the agent address (v1) are new. The request-id, error
+ *	  fields (v2) and the message header are left to the caller, one per
+ *	  target.
+ * @param trap - Installed entry of trap_list.
+ * @param v2 - Trap2/Inform contents instead of the SNMPv1 Trap-PDU ones.
+ * @param ber - Receives the contents, starting an empty _packet.
+ * @return - The API status code.
+ */
+SNMP_API_STAT_CODES AgentuinoClass::encodeTrap(TRAP *trap, bool v2, SNMP_BER_WRITER *ber)
+{
+	uint16_t mark;
+
+	time_ticks = millis()/10;	// traps may be sent from a timer, not after listen()
+
+	ber->begin(_packet, SNMP_MAX_PACKET_LEN);
+	// the variable-bindings list is always present, possibly empty
+	writeTrapVarBinds(ber, trap->varBindList, trap->varOids);
+	if(!v2)
+	{
+		ber->close(SNMP_SYNTAX_SEQUENCE, 0);
+		ber->writeInteger(SNMP_SYNTAX_TIME_TICKS, time_ticks);
+
+		// the address may change (DHCP), it keeps its 4 bytes
+		_transport->localIP(trap->header + trap->addrPos);
+		ber->writeBytes(trap->header, trap->headerSize);
+	}
+	else
+	{
+		// sysUpTime.0 and snmpTrapOID.0 come first
+		ber->writeBytes(trap->header + trap->headerSize, trap->notifySize);
+		mark = ber->size();
+		ber->writeInteger(SNMP_SYNTAX_TIME_TICKS, time_ticks);
+		ber->writeTLV(SNMP_SYNTAX_OID, SNMP_SYS_UP_TIME_0, sizeof(SNMP_SYS_UP_TIME_0));
+		ber->close(SNMP_SYNTAX_SEQUENCE, mark);
+		ber->close(SNMP_SYNTAX_SEQUENCE, 0);
+	}
+	if(ber->overflow)
+		return SNMP_API_STAT_PACKET_TOO_BIG;
+
+	return SNMP_API_STAT_SUCCESS;
+}
+
+/*
+ * @brief Sends (or queues) a trap to every target, the NMS given to begin()
+ *	  when none was added. The contents are encoded at most once per
+ *	  version; for each target only the message header in front of them
+ *	  is rewritten.
+ * @param trap - Entry of trap_list.
+ * @return void
+ */
+void AgentuinoClass::notifyTargets(int8_t trap)
+{
+	SNMP_TRAP_TARGET nms;
+	SNMP_TRAP_TARGET *targets = _trapTargets;
+	uint8_t count = _trapTargetCount;
+	SNMP_BER_WRITER ber;
+	uint16_t contents;
+
+	if(count == 0)
+	{
+		memcpy(nms.ip, NMS.data, 4);
+		nms.port = 162;
+		strcpy(nms.community, _trapCommName);
+		nms.type = _notifyType;
+		targets = &nms;
+		count = 1;
+	}
+
+	for(uint8_t v2 = 0; v2 < 2; v2++)
+	{
+		bool encoded = false;
+
+		for(uint8_t k = 0; k < count; k++)
+		{
+			SNMP_TRAP_TARGET *target = targets + k;
+
+			if((target->type != SNMP_PDU_TRAP) != (bool) v2)
+				continue;
+			if(!encoded)
+			{
+				if(encodeTrap(trap_list + trap, v2, &ber))
+				{
+					// cannot change until the bindings do, the others still run
+					Serial.println(F("encodeTrap error"));
+					break;
+				}
+				contents = ber.size();
+				encoded = true;
+			}
+			ber.truncate(contents);
+			if(v2)
+			{
+				// a request-id per target, an inform ack then matches one entry only
+				_notifyRequestId = (_notifyRequestId + 1) & 0x7FFFFFFF;
+				ber.writeInteger(SNMP_SYNTAX_INT, (int32_t) 0);	// error-index
+				ber.writeInteger(SNMP_SYNTAX_INT, (int32_t) 0);	// error-status
+				ber.writeInteger(SNMP_SYNTAX_INT, _notifyRequestId);
+			}
+			writeHeaders(&ber, target->type, v2 ? SNMP_VERSION_2C : SNMP_VERSION_1, target->community);
+			if(ber.overflow)
+				continue;
+			// sent or queued, a failed send is retried by flushTraps()
+			queueTrap(trap, target->ip, target->port, target->type == SNMP_PDU_INFORM);
+		}
+	}
+}
+
+// frees the trap table with the headers and encoded OIDs of the installed traps
+void AgentuinoClass::clearTraps(void)
+{
+	if(trap_list != NULL)
+	{
+		for(int8_t i = 0; i <= trapNum; i++)
+		{
+			SNMP_FREE(trap_list[i].header);
+			SNMP_FREE(trap_list[i].varOids);
+			if(trap_list[i].ownsOid)
+				free((void *) trap_list[i].berOid);
+		}
+	}
+	SNMP_FREE(trap_list);
+	trapNum = -1;
+}
+
+// syntaxes a trap can watch, conditions are evaluated on the object's own type
+static bool trapSyntax(SNMP_SYNTAXES type)
+{
+	switch(type)
+	{
+		case(SNMP_SYNTAX_UINT32):
+		case(SNMP_SYNTAX_INT):
+		case(SNMP_SYNTAX_COUNTER):
+		case(SNMP_SYNTAX_GAUGE):
+		case(SNMP_SYNTAX_TIME_TICKS):
+		case(SNMP_SYNTAX_COUNTER64):
+			return true;
+		default:
+			return false;
+	}
+}
+
+// reads a watched variable: INT is signed, COUNTER64 keeps its bits in the int64_t
+static int64_t trapSample(SNMP_SYNTAXES type, const void *var)
+{
+	switch(type)
+	{
+		case(SNMP_SYNTAX_INT):
+			return *((const int32_t *) var);
+		case(SNMP_SYNTAX_COUNTER64):
+			return (int64_t) *((const uint64_t *) var);
+		default:
+			return *((const uint32_t *) var);
+	}
+}
+
+// change between two samples, counters and time ticks wrap around
+static int64_t trapDelta(SNMP_SYNTAXES type, int64_t now, int64_t last)
+{
+	switch(type)
+	{
+		case(SNMP_SYNTAX_COUNTER):
+		case(SNMP_SYNTAX_TIME_TICKS):
+			return (uint32_t) ((uint32_t) now - (uint32_t) last);
+		case(SNMP_SYNTAX_COUNTER64):
+			return (int64_t) ((uint64_t) now - (uint64_t) last);
+		default:
+			return now - last;
+	}
+}
+
+template<typename T>
+static bool trapRelation(enum relational_op op, T a, T b)
+{
+	//table_rel: basic relational operations
+	//----------------------------------------------------
+	//bit| 7 | 6 |   5  |  4  |   3  |   2  |   1  |  0  |
+	//====================================================
+	//val| 1 | 1 | a!=b | a==b | a>=b | a>b | a<=b | a<b |
+	//----------------------------------------------------
+	uint8_t table_rel = 0b11000000;
+
+	table_rel |= ((a!=b)<<NOT_EQUAL);
+	table_rel |= ((a==b)<<EQUAL);
+	table_rel |= ((a>=b)<<GREATER_OR_EQUAL);
+	table_rel |= ((a>b)<<GREATER_THAN);
+	table_rel |= ((a<=b)<<LESS_OR_EQUAL);
+	table_rel += (a<b);
+
+	return (1<<op) & table_rel;
+}
+
+// relation of two samples of type, COUNTER64 ones compare unsigned
+static bool trapOrder(SNMP_SYNTAXES type, enum relational_op op, int64_t a, int64_t b)
+{
+	if(type == SNMP_SYNTAX_COUNTER64)
+		return trapRelation<uint64_t>(op, a, b);
+
+	return trapRelation<int64_t>(op, a, b);
+}
+
+// evaluates the relational operator of trap with a as a and measure as b
+static bool trapCompare(const TRAP *trap, int64_t a, const void *measure)
+{
+	return trapOrder(trap->objType, trap->condition, a, trapSample(trap->objType, measure));
+}
+
+// adds an entry to (or removes it from) the window sum; COUNTER64 entries
+// are unsigned and the sum carries past 2^64 instead of overflowing
+static void trapSum(SNMP_TRAP_SAMPLES *st, SNMP_SYNTAXES type, int64_t entry, bool remove)
+{
+	uint64_t sum = st->sum;
+
+	if(type != SNMP_SYNTAX_COUNTER64)
+	{
+		st->sum += remove ? -entry : entry;
+		return;
+	}
+	if(remove)
+	{
+		if(sum < (uint64_t) entry)
+			st->carry--;
+		sum -= entry;
+	}
+	else
+	{
+		sum += entry;
+		if(sum < (uint64_t) entry)
+			st->carry++;
+	}
+	st->sum = sum;
+}
+
+// (carry * 2^64 + sum) * scale / div in 32 bit digits, saturated to 64 bits
+static uint64_t trapDivide(uint8_t carry, uint64_t sum, uint16_t scale, uint32_t div)
+{
+	uint32_t digit[3] = { carry, (uint32_t) (sum >> 32), (uint32_t) sum };
+	uint64_t part = 0, result = 0;
+
+	for(int8_t i = 2; i >= 0; i--)
+	{
+		part += (uint64_t) digit[i] * scale;
+		digit[i] = (uint32_t) part;
+		part >>= 32;
+	}
+	// part, the digit above the three, is at most scale
+	for(uint8_t i = 0; i < 3; i++)
+	{
+		part = (part << 32) | digit[i];
+		if(i == 0 && part >= div)
+			return ~(uint64_t) 0;
+		result = (result << 32) | (part / div);
+		part %= div;
+	}
+	return result;
+}
+
+/*
+ * @brief Takes one sample of the watched variable and computes the measure of
+ *	  the trap from it, in O(1) from the per-trap window.
+ * @param trap - Entry of trap_list.
+ * @param result - Receives the measure.
+ * @return false while there are not enough samples for the measure.
+ */
+static bool trapMeasure(TRAP *trap, int64_t *result)
+{
+	SNMP_TRAP_SAMPLES *st = &trap->samples;
+	uint8_t size = trap->window ? trap->window : SNMP_TRAP_WINDOW;
+	uint32_t now = millis();
+	int64_t value = trapSample(trap->objType, trap->object_var);
+	bool valid = true;
+	uint8_t slot;
+
+	switch(trap->measure)
+	{
+		case(SNMP_TRAP_DELTA):
+			valid = st->samples > 0;
+			*result = trapDelta(trap->objType, value, st->last);
+		break;
+		case(SNMP_TRAP_RATE):
+		case(SNMP_TRAP_AVERAGE):
+		{
+			int64_t entry = value;
+			uint32_t span = 0;
+
+			if(trap->measure == SNMP_TRAP_RATE)
+			{
+				if(st->samples == 0)
+				{
+					valid = false;
+					break;
+				}
+				entry = trapDelta(trap->objType, value, st->last);
+				span = now - st->lastTime;
+			}
+			if(st->count == size)
+			{
+				trapSum(st, trap->objType, st->value[st->first], true);
+				st->span -= st->time[st->first];
+				st->first = (st->first + 1) % size;
+				st->count--;
+			}
+			slot = (st->first + st->count++) % size;
+			st->value[slot] = entry;
+			st->time[slot] = span;
+			trapSum(st, trap->objType, entry, false);
+			st->span += span;
+
+			if(trap->measure == SNMP_TRAP_RATE && st->span == 0)
+				valid = false;
+			else if(trap->objType == SNMP_SYNTAX_COUNTER64)
+				*result = trapDivide(st->carry, st->sum, trap->measure == SNMP_TRAP_RATE ? 1000 : 1,
+						     trap->measure == SNMP_TRAP_RATE ? st->span : st->count);
+			else if(trap->measure == SNMP_TRAP_AVERAGE)
+				*result = st->sum / st->count;
+			else
+				*result = st->sum * 1000 / st->span;
+		}
+		break;
+		case(SNMP_TRAP_MIN):
+		case(SNMP_TRAP_MAX):
+			// the oldest sample leaves the window from the front
+			if(st->count > 0 && st->samples - st->time[st->first] >= size)
+			{
+				st->first = (st->first + 1) % size;
+				st->count--;
+			}
+			// samples that can never be the extreme again leave from the back
+			while(st->count > 0)
+			{
+				int64_t back = st->value[(st->first + st->count - 1) % size];
+
+				if(!trapOrder(trap->objType, trap->measure == SNMP_TRAP_MIN ?
+					      GREATER_OR_EQUAL : LESS_OR_EQUAL, back, value))
+					break;
+				st->count--;
+			}
+			slot = (st->first + st->count++) % size;
+			st->value[slot] = value;
+			st->time[slot] = st->samples;
+			*result = st->value[st->first];
+		break;
+		default:
+			*result = value;
+		break;
+	}
+
+	st->last = value;
+	st->lastTime = now;
+	st->samples++;
+
+	return valid;
+}
+
+uint8_t AgentuinoClass::checkTrapList()
+{
+	if(trap_list == NULL || trapNum + 1 > trapListSize - 1)
+	{
+		Serial.println(F("\n\rerror installTrap(): trap_list is FULL or NULL!\n\r"));
+		return 1; //error
+	}
+
+	return 0;
+}
+
+/*
+ * @brief Notice a Trap condition to API.
+ * @param oid - Pointer to trap OID
+ * @param trapType - The type of trap (coldStart, warmStart, enterprise ...)
+ * @param specific - Number of specific trap
+ * @param obj - Pointer for a variable to be monitored.
+ * @param objType - The type of variable to be monitored.
+ * @param rel_op - The relational operator to compare value of obj and base_measure
+ * @see enum relational_op
+ * @param base_measure - Variable to be compared
+ * @param varBindList - Variable attached to trap.
+ * @param trigger - SNMP_TRAP_LEVEL sends on every trapWatcher() call while the
+ *	  condition holds, SNMP_TRAP_EDGE only when it becomes true.
+ * @param rearm_measure - Edge trigger: re-arm once obj no longer satisfies
+ *	  rel_op against this value, e.g. ">= 80" with 70 re-arms below 70.
+ *	  NULL re-arms against base_measure.
+ * @param holdOff - Min ms between two traps of this condition, 0 for none.
+ * @param measure - What is compared: the value, its delta since the last
+ *	  trapWatcher() call, its rate per second or the average, min or max
+ *	  over the last window samples.
+ * @param window - Samples for rate/average/min/max, 1..SNMP_TRAP_WINDOW,
+ *	  0 for SNMP_TRAP_WINDOW.
+ * @return 0 for success, 1 for error
+ */ 
+uint8_t AgentuinoClass::installTrap (const char *oid, SNMP_TRAP_TYPES trapType, 
+				     uint16_t specific, void *obj, SNMP_SYNTAXES objType, 
+ 				     enum relational_op rel_op, void *base_measure,
+				     VAR_BIND_LIST *varBindList, SNMP_TRAP_TRIGGERS trigger,
+				     void *rearm_measure, uint32_t holdOff,
+				     SNMP_TRAP_MEASURES measure, uint8_t window)
+{
+	char text[SNMP_MAX_OID_LEN];
+	byte *berOid;
+	uint8_t berOidSize;
+
+	// the text is converted here once, sending uses the BER form
+	if(strlen_P((PGM_P) oid) >= SNMP_MAX_OID_LEN)
+		return 1; //error
+	strcpy_P(text, (PGM_P) oid);
+	if(encodeTextOid(text, &berOid, &berOidSize) != SNMP_API_STAT_SUCCESS)
+		return 1; //error
+
+	if(installTrap(berOid, berOidSize, trapType, specific, obj, objType,
+		       rel_op, base_measure, varBindList, trigger, rearm_measure, holdOff,
+		       measure, window))
+	{
+		free(berOid);
+		return 1; //error
+	}
+	strcpy(trap_list[trapNum].oid, text);
+	trap_list[trapNum].ownsOid = true;	// freed by clearTraps()
+
+	return 0;
+}
+
+/*
+ * @brief Notice a Trap condition to API with a BER encoded trap OID.
+ * @param oid - BER encoded trap OID (e.g. SNMP_OID_BER(1,3,6,...)), must outlive the agent.
+ * @param oidSize - Number of bytes in oid.
+ * @return 0 for success, 1 for error
+ * @see installTrap(const char *oid, ...) for the other parameters.
+ */ 
+uint8_t AgentuinoClass::installTrap (const byte *oid, uint8_t oidSize, SNMP_TRAP_TYPES trapType,
+				     uint16_t specific, void *obj, SNMP_SYNTAXES objType,
+				     enum relational_op rel_op, void *base_measure,
+				     VAR_BIND_LIST *varBindList, SNMP_TRAP_TRIGGERS trigger,
+				     void *rearm_measure, uint32_t holdOff,
+				     SNMP_TRAP_MEASURES measure, uint8_t window)
+{
+	if(!trapSyntax(objType) || window > SNMP_TRAP_WINDOW)
+		return 1; //error
+	if(checkTrapList())
+		return 1; //error
+	if(encodeVarBindOids(varBindList, &trap_list[trapNum + 1].varOids) != SNMP_API_STAT_SUCCESS)
+		return 1; //error
+
+	trap_list[++trapNum].objType = objType;
+	trap_list[trapNum].trapType = trapType;
+	trap_list[trapNum].specificTrap = specific;
+	trap_list[trapNum].oid[0] = '\0';
+	trap_list[trapNum].berOid = oid;
+	trap_list[trapNum].berOidSize = oidSize;
+	trap_list[trapNum].ownsOid = false;
+	trap_list[trapNum].object_var = obj;
+	trap_list[trapNum].condition  = rel_op;
+	trap_list[trapNum].base_measure = base_measure;
+	trap_list[trapNum].send = false;
+	trap_list[trapNum].varBindList = varBindList;
+	trap_list[trapNum].trigger = trigger;
+	trap_list[trapNum].rearm_measure = rearm_measure;
+	trap_list[trapNum].holdOff = holdOff;
+	trap_list[trapNum].armed = true;
+	trap_list[trapNum].sent = false;
+	trap_list[trapNum].lastSent = 0;
+	trap_list[trapNum].measure = measure;
+	trap_list[trapNum].window = window;
+	memset(&trap_list[trapNum].samples, 0, sizeof(SNMP_TRAP_SAMPLES));
+	trap_list[trapNum].header = NULL;
+	if(buildTrapHeader(trap_list + trapNum) != SNMP_API_STAT_SUCCESS)
+	{
+		SNMP_FREE(trap_list[trapNum].varOids);
+		trapNum--;
+		return 1; //error
+	}
+	
+	return 0;
+}
+
+/*
+ * @brief Notice a Trap condition to API.
+ * @param oid - Pointer to a not null trap struct. berOid must be NULL or
+ *	  valid; when NULL the text oid is encoded here once. trigger,
+ *	  rearm_measure, holdOff, measure and window must be set, the state
+ *	  fields and samples are reset here.
+ * @return 0 for success, 1 for error
+ */ 
+
+uint8_t AgentuinoClass::installTrap(TRAP *trap)
+{
+	TRAP *entry;
+
+	if(!trapSyntax(trap->objType) || trap->window > SNMP_TRAP_WINDOW)
+		return 1; //error
+	if(checkTrapList())
+		return 1; //error
+
+	entry = trap_list + trapNum + 1;
+	memcpy(entry, trap, sizeof(TRAP));
+	entry->ownsOid = false;
+	if(encodeVarBindOids(entry->varBindList, &entry->varOids) != SNMP_API_STAT_SUCCESS)
+		return 1; //error
+	if(entry->berOid == NULL)
+	{
+		byte *berOid;
+
+		if(encodeTextOid(entry->oid, &berOid, &entry->berOidSize) != SNMP_API_STAT_SUCCESS)
+		{
+			SNMP_FREE(entry->varOids);
+			return 1; //error
+		}
+		entry->berOid = berOid;
+		entry->ownsOid = true;
+	}
+	entry->armed = true;
+	entry->sent = false;
+	entry->lastSent = 0;
+	memset(&entry->samples, 0, sizeof(SNMP_TRAP_SAMPLES));
+	entry->header = NULL;
+	if(buildTrapHeader(entry) != SNMP_API_STAT_SUCCESS)
+	{
+		SNMP_FREE(entry->varOids);
+		if(entry->ownsOid)
+			free((void *) entry->berOid);
+		return 1; //error
+	}
+	trapNum++;
+
+	return 0;
+}
+
+/*
+ * @brief Decides if a trap has to be sent now: the condition on the measure
+ *	  holds, an edge trigger is armed and the hold-off since the last trap
+ *	  has passed.
+ *	  Re-arms an edge trigger once the value left the hysteresis band.
+ * @param trap - Entry of trap_list.
+ * @return true if the trap is due.
+ */
+bool AgentuinoClass::trapDue(TRAP *trap)
+{
+	int64_t value;
+
+	if(!trapMeasure(trap, &value))
+		return false;
+
+	if(!trapCompare(trap, value, trap->base_measure))
+	{
+		if(!trap->armed && !trapCompare(trap, value, trap->rearm_measure != NULL ?
+						  trap->rearm_measure : trap->base_measure))
+			trap->armed = true;
+		return false;
+	}
+
+	if(trap->trigger == SNMP_TRAP_EDGE && !trap->armed)
+		return false;
+
+	// a transition inside the hold-off stays armed and is sent once it expires
+	return !trap->sent || millis() - trap->lastSent >= trap->holdOff;
+}
+
+/*
+ * @brief This function check if some condition in "trap_list" has been achieved. 
+ * @params: void
+ * @return: 255 if trap_list is null, otherwise return Number of conditions traps achieved.
+*/
+uint8_t AgentuinoClass::trapWatcher(void)
+{
+	uint8_t achievedTraps = 0;
+
+	if(trapNum < 0)
+		return 255;
+
+	// earlier traps go first, a new one never overtakes a pending one
+	flushTraps();
+
+	for(uint8_t i = 0; i <= trapNum; i++)
+	{
+		trap_list[i].send = trapDue(trap_list + i);
+
+		if(trap_list[i].send)
+		{
+			achievedTraps++;
+
+			notifyTargets(i);
+			trap_list[i].send = false;
+			trap_list[i].armed = false;
+			trap_list[i].sent = true;
+			trap_list[i].lastSent = millis();
+		}
+	}
+
+	return achievedTraps;
+}
+
+/*
+ * @brief Sends the trap message encoded in _packet, or queues it when the
+ *	  transport does not take it or earlier traps are still pending.
+ *	  A full queue loses a trap as set by setTrapOverflow().
+ * @param trap - Entry of trap_list the message belongs to.
+ * @param ip - Destination address.
+ * @param port - Destination port.
+ * @param inform - The message is an inform, it also waits for room in the
+ *	  inform window.
+ * @return void
+ */
+void AgentuinoClass::queueTrap(int8_t trap, const uint8_t *ip, uint16_t port, bool inform)
+{
+#if SNMP_TRAP_QUEUE_SIZE
+	SNMP_QUEUED_TRAP *entry = NULL;
+	// else queued behind the pending ones or a full inform window
+	bool sendNow = _trapCount == 0 && (!inform || _informCount < _informWindow);
+	bool append = false;
+	byte *data;
+
+	if(sendNow && sendNotify(ip, port, _packet + _packetPos, _packetSize, inform) == SNMP_API_STAT_SUCCESS)
+		return;
+
+	if(_trapCount == SNMP_TRAP_QUEUE_SIZE)
+	{
+		_trapsDropped++;
+		if(_trapOverflow == SNMP_TRAP_COALESCE)
+		{
+			// the newest pending trap of the same entry is replaced in place
+			for(uint8_t k = _trapCount; k-- > 0 && entry == NULL; )
+			{
+				SNMP_QUEUED_TRAP *pending = _trapQueue + (_trapFirst + k) % SNMP_TRAP_QUEUE_SIZE;
+
+				if(pending->trap == trap && pending->port == port && !memcmp(pending->ip, ip, 4))
+					entry = pending;
+			}
+		}
+		if(entry == NULL)
+		{
+			_trapFirst = (_trapFirst + 1) % SNMP_TRAP_QUEUE_SIZE;
+			_trapCount--;
+		}
+	}
+	if(entry == NULL)
+	{
+		entry = _trapQueue + (_trapFirst + _trapCount) % SNMP_TRAP_QUEUE_SIZE;
+		// a trap tried just now waits for its first retry
+		entry->attempts = sendNow;
+		entry->due = millis() + (sendNow ? SNMP_TRAP_RETRY_MS : 0);
+		append = true;
+	}
+
+	data = (byte *) realloc(entry->data, _packetSize);
+	if(data == NULL)
+	{
+		// the slot is not taken, the trap is lost
+		Serial.println(F("Trap not Send"));
+		return;
+	}
+	memcpy(data, _packet + _packetPos, _packetSize);
+	entry->data = data;
+	entry->size = _packetSize;
+	entry->trap = trap;
+	memcpy(entry->ip, ip, 4);
+	entry->port = port;
+	entry->inform = inform;
+	if(append)
+		_trapCount++;
+#if !defined(ARDUINO)
+	saveTrapQueue();
+#endif
+#else
+	if(sendNotify(ip, port, _packet + _packetPos, _packetSize, inform) != SNMP_API_STAT_SUCCESS)
+	{
+		_trapsDropped++;
+		Serial.println(F("Trap not Send"));
+	}
+#endif
+}
+
+/**
+ * @brief Sends the pending traps whose retry time has come, oldest first.
+ *	  A failed send doubles the retry interval of that trap (up to
+ *	  SNMP_TRAP_RETRY_MAX_MS) and keeps the ones after it waiting, so
+ *	  traps arrive in order. Unacknowledged informs are retransmitted
+ *	  first. trapWatcher() calls it, it never blocks.
+ * @return - Number of traps still pending.
+ */ 
+uint8_t AgentuinoClass::flushTraps(void)
+{
+	retryInforms();
+#if SNMP_TRAP_QUEUE_SIZE
+	uint32_t now = millis();
+	uint8_t count = _trapCount;
+
+	while(_trapCount > 0)
+	{
+		SNMP_QUEUED_TRAP *entry = _trapQueue + _trapFirst;
+
+		if((int32_t) (now - entry->due) < 0)
+			break;
+		if(entry->inform && _informCount >= _informWindow)
+			break;	// until an ack makes room, no backoff
+		if(sendNotify(entry->ip, entry->port, entry->data, entry->size, entry->inform)
+		   != SNMP_API_STAT_SUCCESS)
+		{
+			uint32_t delay = SNMP_TRAP_RETRY_MS;
+
+			for(uint8_t k = 0; k < entry->attempts && delay < SNMP_TRAP_RETRY_MAX_MS; k++)
+				delay <<= 1;
+			if(delay > SNMP_TRAP_RETRY_MAX_MS)
+				delay = SNMP_TRAP_RETRY_MAX_MS;
+			if(entry->attempts < 0xFF)
+				entry->attempts++;
+			entry->due = now + delay;
+			break;
+		}
+		_trapFirst = (_trapFirst + 1) % SNMP_TRAP_QUEUE_SIZE;
+		_trapCount--;
+	}
+#if !defined(ARDUINO)
+	if(_trapCount != count)
+		saveTrapQueue();
+#endif
+	return _trapCount;
+#else
+	return 0;
+#endif
+}
+
+uint8_t AgentuinoClass::pendingTraps(void)
+{
+#if SNMP_TRAP_QUEUE_SIZE
+	return _trapCount;
+#else
+	return 0;
+#endif
+}
+
+/**
+ * @brief Select the notifications trapWatcher() sends.
+ * @param type - SNMP_PDU_TRAP (SNMPv1 trap, the default), SNMP_PDU_TRAP2
+ *	  (SNMPv2c trap) or SNMP_PDU_INFORM (SNMPv2c inform, acknowledged by
+ *	  the manager and retransmitted until it is).
+ * @return - The API status code.
+ */ 
+SNMP_API_STAT_CODES AgentuinoClass::setNotifyType(SNMP_PDU_TYPES type)
+{
+	if(type != SNMP_PDU_TRAP && type != SNMP_PDU_TRAP2 && type != SNMP_PDU_INFORM)
+		return SNMP_API_STAT_PACKET_INVALID;
+	_notifyType = type;
+	return SNMP_API_STAT_SUCCESS;
+}
+
+/**
+ * @brief Add a manager every trap is sent to. Once a target is added, the
+ *	  NMS given to begin() is no longer notified unless added as well.
+ *	  Each trap is encoded once per SNMP version, whatever the number of
+ *	  targets.
+ * @param ip - IPv4 address of the manager.
+ * @param port - UDP port, usually 162.
+ * @param community - Community name for this manager.
+ * @param type - SNMP_PDU_TRAP (v1), SNMP_PDU_TRAP2 or SNMP_PDU_INFORM (v2c).
+ * @return - The API status code, SNMP_API_STAT_MALLOC_ERR when all
+ *	     SNMP_MAX_TRAP_TARGETS are taken.
+ */ 
+SNMP_API_STAT_CODES AgentuinoClass::addTrapTarget(const uint8_t *ip, uint16_t port, const char *community,
+						  SNMP_PDU_TYPES type)
+{
+	SNMP_TRAP_TARGET *target;
+
+	if(type != SNMP_PDU_TRAP && type != SNMP_PDU_TRAP2 && type != SNMP_PDU_INFORM)
+		return SNMP_API_STAT_PACKET_INVALID;
+	if(strlen(community) > SNMP_MAX_NAME_LEN)
+		return SNMP_API_STAT_NAME_TOO_BIG;
+	if(_trapTargetCount == SNMP_MAX_TRAP_TARGETS)
+		return SNMP_API_STAT_MALLOC_ERR;
+
+	target = _trapTargets + _trapTargetCount++;
+	memcpy(target->ip, ip, 4);
+	target->port = port;
+	strcpy(target->community, community);
+	target->type = type;
+
+	return SNMP_API_STAT_SUCCESS;
+}
+
+/**
+ * @brief Set how many informs may wait for their ack at once. Further
+ *	  informs wait in the trap queue until an ack makes room.
+ * @param window - 1..SNMP_MAX_INFORMS, larger values are clamped.
+ * @return void
+ */ 
+void AgentuinoClass::setInformWindow(uint8_t window)
+{
+	_informWindow = window == 0 ? 1 : (window > SNMP_MAX_INFORMS ? SNMP_MAX_INFORMS : window);
+}
+
+static bool peekRequestId(const byte *packet, uint16_t size, int32_t *requestId);
+
+/*
+ * @brief Sends a trap or inform message. An inform sent goes into the
+ *	  outstanding table, the caller checked that the window has room.
+ * @param ip - Destination address.
+ * @param port - Destination port.
+ * @param data - Encoded message.
+ * @param size - Bytes in data.
+ * @param inform - The message is an inform.
+ * @return - The API status code.
+ */
+SNMP_API_STAT_CODES AgentuinoClass::sendNotify(const uint8_t *ip, uint16_t port,
+					       const byte *data, uint16_t size, bool inform)
+{
+	SNMP_INFORM *entry = NULL;
+	SNMP_API_STAT_CODES status;
+	int32_t requestId;
+	byte *copy;
+
+	if(_transport == NULL)
+		return SNMP_API_STAT_SOCKET_ERR;
+	// never batched: a send that fails must stay in the trap queue
+	status = _transport->sendUnbatched(ip, port, data, size);
+	if(status != SNMP_API_STAT_SUCCESS || !inform || !peekRequestId(data, size, &requestId))
+		return status;
+
+	for(uint8_t i = 0; i < SNMP_MAX_INFORMS && entry == NULL; i++)
+	{
+		if(!_informs[i].active)
+			entry = _informs + i;
+	}
+	if(entry == NULL)
+		return status;
+	copy = (byte *) realloc(entry->data, size);
+	if(copy == NULL)
+	{
+		// sent, only never retransmitted
+		_informsFailed++;
+		return status;
+	}
+	memcpy(copy, data, size);
+	entry->data = copy;
+	entry->size = size;
+	entry->requestId = requestId;
+	memcpy(entry->ip, ip, 4);
+	entry->port = port;
+	entry->retries = 0;
+	entry->due = millis() + _informTimeout;
+	entry->active = true;
+	_informCount++;
+
+	return status;
+}
+
+// retransmits the informs whose ack is overdue, gives up after the retries
+void AgentuinoClass::retryInforms(void)
+{
+	uint32_t now = millis();
+
+	for(uint8_t i = 0; i < SNMP_MAX_INFORMS && _informCount > 0; i++)
+	{
+		SNMP_INFORM *entry = _informs + i;
+
+		if(!entry->active || (int32_t) (now - entry->due) < 0)
+			continue;
+		if(entry->retries >= _informRetries)
+		{
+			entry->active = false;
+			_informCount--;
+			_informsFailed++;
+			continue;
+		}
+		entry->retries++;
+		entry->due = now + _informTimeout;
+		if(_transport != NULL)
+			_transport->sendUnbatched(entry->ip, entry->port, entry->data, entry->size);
+	}
+}
+
+/*
+ * @brief Takes the pending datagram as the ack of an inform: a noError
+ *	  Response with the request-id, version and community of an
+ *	  outstanding inform, from the address and port it was sent to.
+ * @param void
+ * @return true if the datagram was such an ack and is consumed.
+ */
+bool AgentuinoClass::ackInform(void)
+{
+	SNMP_PDU_VIEW view, sent;
+
+	if(_informCount == 0 || _packetSize > SNMP_MAX_PACKET_LEN)
+		return false;
+	readPacket();
+	if(view.parse(_packet, _packetSize) != SNMP_API_STAT_SUCCESS || view.type != SNMP_PDU_RESPONSE
+	   || view.error != SNMP_ERR_NO_ERROR)
+		return false;
+	for(uint8_t i = 0; i < SNMP_MAX_INFORMS; i++)
+	{
+		SNMP_INFORM *entry = _informs + i;
+
+		if(!entry->active || entry->requestId != view.requestId
+		   || memcmp(entry->ip, _dstIp, 4) || entry->port != _dstPort)
+			continue;
+		// the community is only in the inform message itself
+		if(sent.parse(entry->data, entry->size) == SNMP_API_STAT_SUCCESS
+		   && sent.version == view.version && sent.community.size == view.community.size
+		   && !memcmp(sent.community.data, view.community.data, view.community.size))
+		{
+			entry->active = false;
+			_informCount--;
+			_informsAcked++;
+			// room in the window for the informs waiting in the queue
+			flushTraps();
+			return true;
+		}
+	}
+	return false;
+}
+
+#if !defined(ARDUINO) && SNMP_TRAP_QUEUE_SIZE
+/**
+ * @brief Keep the pending traps in a file, so they survive a restart. The
+ *	  traps in the file replace the pending ones (oldest first, sent by
+ *	  the next flushTraps()); afterwards the file follows every change of
+ *	  the queue. Host build only.
+ * @param path - File name, must outlive the agent. NULL stops saving.
+ * @return - SNMP_API_STAT_NAME_TOO_BIG if path and ".tmp" do not fit into
+ *	     SNMP_TRAP_FILE_LEN, nothing is saved then.
+ */ 
+SNMP_API_STAT_CODES AgentuinoClass::setTrapQueueFile(const char *path)
+{
+	FILE *file;
+	byte head[9];
+
+	_trapFile = NULL;
+	if(path == NULL)
+		return SNMP_API_STAT_SUCCESS;
+	if(strlen(path) + sizeof(".tmp") > SNMP_TRAP_FILE_LEN)
+		return SNMP_API_STAT_NAME_TOO_BIG;
+
+	// the file holds the whole queue, on top of the pending traps it would send them twice
+	_trapFirst = 0;
+	_trapCount = 0;
+
+	file = fopen(path, "rb");
+	if(file != NULL)
+	{
+		// per trap: ip[4], port, size (big endian), inform flag and the message
+		while(_trapCount < SNMP_TRAP_QUEUE_SIZE && fread(head, 1, 9, file) == 9)
+		{
+			SNMP_QUEUED_TRAP *entry = _trapQueue + (_trapFirst + _trapCount) % SNMP_TRAP_QUEUE_SIZE;
+			uint16_t size = (head[6] << 8) | head[7];
+			byte *data;
+
+			if(size == 0 || size > SNMP_MAX_PACKET_LEN)
+				break;
+			data = (byte *) realloc(entry->data, size);
+			if(data == NULL)
+				break;
+			entry->data = data;
+			if(fread(data, 1, size, file) != size)
+				break;
+			entry->size = size;
+			entry->trap = -1;
+			memcpy(entry->ip, head, 4);
+			entry->port = (head[4] << 8) | head[5];
+			entry->inform = head[8];
+			entry->attempts = 0;
+			entry->due = millis();
+			_trapCount++;
+		}
+		fclose(file);
+	}
+	_trapFile = path;
+	saveTrapQueue();
+
+	return SNMP_API_STAT_SUCCESS;
+}
+
+// rewrites the queue file, through a temporary one so a crash never leaves half a queue.
+// Only pending traps change it, a trap sent at once never touches the file.
+void AgentuinoClass::saveTrapQueue(void)
+{
+	char temp[SNMP_TRAP_FILE_LEN];
+	FILE *file;
+	bool written;
+
+	if(_trapFile == NULL)
+		return;
+	snprintf(temp, sizeof(temp), "%s.tmp", _trapFile);	// fits, see setTrapQueueFile()
+	file = fopen(temp, "wb");
+	if(file == NULL)
+		return;
+	for(uint8_t k = 0; k < _trapCount; k++)
+	{
+		SNMP_QUEUED_TRAP *entry = _trapQueue + (_trapFirst + k) % SNMP_TRAP_QUEUE_SIZE;
+		byte head[9];
+
+		memcpy(head, entry->ip, 4);
+		head[4] = entry->port >> 8;
+		head[5] = entry->port;
+		head[6] = entry->size >> 8;
+		head[7] = entry->size;
+		head[8] = entry->inform;
+		fwrite(head, 1, 9, file);
+		fwrite(entry->data, 1, entry->size, file);
+	}
+	// on disk before the rename makes it the queue
+	written = fflush(file) == 0 && !ferror(file) && fsync(fileno(file)) == 0;
+	if(fclose(file) == 0 && written)
+		rename(temp, _trapFile);
+	else
+		remove(temp);
+}
+#endif
+
+SNMP_API_STAT_CODES AgentuinoClass::sendTrap(
+        SNMP_PDU *pdu, const uint8_t* manager)
+{
+    	uint32_u ip;
+	SNMP_BER_WRITER ber;
+
+    	_dstType = pdu->type;// = SNMP_PDU_TRAP;
+	pdu->version = SNMP_VERSION_1;
+
+	ber.begin(_packet, SNMP_MAX_PACKET_LEN);
+
+	// the variable-bindings list is always present, possibly empty
+	ber.writeTLV(SNMP_SYNTAX_SEQUENCE, pdu->trap_data, pdu->trap_data_size);
+	SNMP_FREE(pdu->trap_data);
+
+	ber.writeInteger(SNMP_SYNTAX_TIME_TICKS, pdu->time_ticks);
+	ber.writeInteger(SNMP_SYNTAX_INT, pdu->specific_trap);
+	ber.writeInteger(SNMP_SYNTAX_INT, pdu->trap_type);
+
+	_transport->localIP(ip.data);
+	pdu->address = ip.data;
+	ber.writeTLV(SNMP_SYNTAX_IP_ADDRESS, ip.data, 4);
+
+	ber.writeTLV(SNMP_SYNTAX_OID, pdu->OID.data, pdu->OID.size);
+
+    	writeHeaders(&ber, pdu->type, pdu->version);
+	if(ber.overflow)
+		return SNMP_API_STAT_PACKET_TOO_BIG;
+
+    return writePacket(manager, 162);
+}
+
+//#endif
+
+//
+// BER decoding helpers, every read is checked against end
+//
+// reads a tag and a definite length (short or long form), pos is left on the contents
+static bool readHeader(const byte *packet, uint16_t end, uint16_t *pos, byte *tag, uint16_t *len)
+{
+	if ( *pos + 2 > end ) return false;
+	*tag = packet[(*pos)++];
+	*len = packet[(*pos)++];
+	if ( *len & 0x80 ) {
+		// long form, 0x80 (indefinite) and more than 2 length bytes are refused
+		byte n = *len & 0x7F;
+		if ( n == 0 || n > 2 || *pos + n > end ) return false;
+		*len = 0;
+		while ( n-- ) {
+			*len = (*len << 8) | packet[(*pos)++];
+		}
+	}
+	return *len <= end - *pos;
+}
+
+// reads an INTEGER of up to 4 bytes (sign extended)
+static bool readInteger(const byte *packet, uint16_t end, uint16_t *pos, int32_t *value)
+{
+	byte tag;
+	uint16_t len;
+	uint32_t v;
+
+	if ( !readHeader(packet, end, pos, &tag, &len) || tag != SNMP_SYNTAX_INT
+		|| len == 0 || len > 4 ) return false;
+	v = (packet[*pos] & 0x80) ? 0xFFFFFFFF : 0;
+	while ( len-- ) {
+		v = (v << 8) | packet[(*pos)++];
+	}
+	*value = (int32_t)v;
+	return true;
+}
+
+/**
+ * @brief Read the pending datagram and decode it with every variable binding.
+ * @param pdu - Receives the request. OID/VALUE hold the first variable binding.
+ * @return - The API status code. SNMP_API_STAT_PACKET_TOO_BIG with pdu->error
+ *	     set to SNMP_ERR_TOO_BIG means the request carries more than
+ *	     SNMP_MAX_VARBINDS bindings; the header fields are valid so the
+ *	     request can still be answered with tooBig.
+ */ 
+SNMP_API_STAT_CODES AgentuinoClass::requestPdu(SNMP_PDU *pdu)
+{
+	pdu->varBindCount = 0;
+	pdu->error = SNMP_ERR_NO_ERROR;
+	//
+	// validate packet (size was set by listen(), UDP header skipped)
+	if ( _packetSize > SNMP_MAX_PACKET_LEN ) {
+		return SNMP_API_STAT_PACKET_TOO_BIG;
+	}
+	//
+	// get UDP packet
+	readPacket();
+	//
+	return parsePdu(pdu);
+}
+
+// copies the pending datagram and its source once, listen() may have done so already
+void AgentuinoClass::readPacket(void)
+{
+	if ( !_packetRead ) {
+		_transport->read(_packet, _packetSize);
+		_transport->remote(_dstIp, &_dstPort);
+		_packetRead = true;
+	}
+}
+
+/**
+ * @brief Read the pending datagram and decode it as a zero-copy view. No
+ *	  value is copied; the slices stay valid until the next datagram is
+ *	  read or a response is written.
+ * @param view - Receives the request.
+ * @return - The API status code, as for requestPdu().
+ */ 
+SNMP_API_STAT_CODES AgentuinoClass::requestView(SNMP_PDU_VIEW *view)
+{
+	SNMP_API_STAT_CODES status;
+
+	view->varBindCount = 0;
+	if ( _packetSize > SNMP_MAX_PACKET_LEN ) {
+		return SNMP_API_STAT_PACKET_TOO_BIG;
+	}
+	readPacket();
+	//
+	status = view->parse(_packet, _packetSize);
+	if ( status != SNMP_API_STAT_SUCCESS ) return status;
+	_dstType = view->type;
+	return checkRequest(view);
+}
+
+// accepts the version and the community of a parsed request for its pdu type
+SNMP_API_STAT_CODES AgentuinoClass::checkRequest(const SNMP_PDU_VIEW *view)
+{
+	const char *community;
+
+	if ( view->version != SNMP_VERSION_1 && view->version != SNMP_VERSION_2C ) {
+		return SNMP_API_STAT_PACKET_INVALID;
+	}
+	//
+	// validate community size
+	if ( view->community.size > SNMP_MAX_NAME_LEN ) {
+		return SNMP_API_STAT_NAME_TOO_BIG;
+	}
+	//
+	// validate community name
+	if ( view->type == SNMP_PDU_SET ) {
+		community = _setCommName;
+	} else if ( view->type == SNMP_PDU_GET || view->type == SNMP_PDU_GET_NEXT ) {
+		community = _getCommName;
+	} else if ( view->type == SNMP_PDU_GET_BULK && view->version == SNMP_VERSION_2C ) {
+		community = _getCommName;
+	} else {
+		community = NULL;
+	}
+	if ( community == NULL || view->community.size != strlen(community)
+		|| memcmp(view->community.data, community, view->community.size) != 0 ) {
+		return SNMP_API_STAT_NO_SUCH_NAME;
+	}
+	return SNMP_API_STAT_SUCCESS;
+}
+
+// decodes the request held in _packet, copying each binding once
+SNMP_API_STAT_CODES AgentuinoClass::parsePdu(SNMP_PDU *pdu)
+{
+	SNMP_PDU_VIEW view;
+	SNMP_VARBIND_ITERATOR it;
+	SNMP_VARBIND_VIEW vb;
+	SNMP_API_STAT_CODES status;
+
+	pdu->varBindCount = 0;
+	status = view.parse(_packet, _packetSize);
+	if ( status != SNMP_API_STAT_SUCCESS ) {
+		return status;
+	}
+	pdu->version = view.version;
+	pdu->type = view.type;
+	pdu->requestId = view.requestId;
+	// the wire error-status of a request may be any integer, it is not kept
+	pdu->error = SNMP_ERR_NO_ERROR;
+	if ( view.type == SNMP_PDU_GET_BULK ) {
+		pdu->nonRepeaters = view.error;
+		pdu->maxRepetitions = view.errorIndex;
+		pdu->errorIndex = 0;
+	} else {
+		pdu->nonRepeaters = 0;
+		pdu->maxRepetitions = 0;
+		pdu->errorIndex = view.errorIndex;
+	}
+	_dstType = pdu->type;
+	//
+	status = checkRequest(&view);
+	if ( status == SNMP_API_STAT_NAME_TOO_BIG ) {
+		// set pdu error
+		pdu->error = SNMP_ERR_TOO_BIG;
+		return status;
+	}
+	if ( status == SNMP_API_STAT_NO_SUCH_NAME ) {
+		// set pdu error
+		pdu->error = SNMP_ERR_NO_SUCH_NAME;
+		return status;
+	}
+	if ( status != SNMP_API_STAT_SUCCESS ) {
+		return status;
+	}
+	if ( view.varBindCount > SNMP_MAX_VARBINDS ) {
+		pdu->error = SNMP_ERR_TOO_BIG;
+		return SNMP_API_STAT_PACKET_TOO_BIG;
+	}
+	//
+	// variable bindings
+	it = view.varBinds();
+	while ( it.next(&vb) ) {
+		SNMP_VARBIND *dst = pdu->varBinds + pdu->varBindCount;
+
+		if ( vb.oid.size > SNMP_MAX_OID_LEN ) {
+			// set pdu error
+			pdu->error = SNMP_ERR_TOO_BIG;
+			return SNMP_API_STAT_OID_TOO_BIG;
+		}
+		if ( vb.value.size > SNMP_MAX_VALUE_LEN ) {
+			// set pdu error
+			pdu->error = SNMP_ERR_TOO_BIG;
+			return SNMP_API_STAT_VALUE_TOO_BIG;
+		}
+		memcpy(dst->OID.data, vb.oid.data, vb.oid.size);
+		dst->OID.size = vb.oid.size;
+		dst->VALUE.syntax = vb.syntax;
+		memcpy(dst->VALUE.data, vb.value.data, vb.value.size);
+		dst->VALUE.size = vb.value.size;
+		dst->cached = NULL;
+		pdu->varBindCount++;
+	}
+	//
+	return SNMP_API_STAT_SUCCESS;
+}
+
+//
+// Retransmission cache
+//
+// request-id of a message, without validating anything behind it
+static bool peekRequestId(const byte *packet, uint16_t size, int32_t *requestId)
+{
+	uint16_t pos = 0, len;
+	int32_t version;
+	byte tag;
+
+	if ( !readHeader(packet, size, &pos, &tag, &len) || tag != SNMP_SYNTAX_SEQUENCE ) return false;
+	if ( !readInteger(packet, size, &pos, &version) ) return false;
+	if ( !readHeader(packet, size, &pos, &tag, &len) || tag != SNMP_SYNTAX_OCTETS ) return false;
+	pos += len;
+	if ( !readHeader(packet, size, &pos, &tag, &len) ) return false;
+	return readInteger(packet, size, &pos, requestId);
+}
+
+static uint32_t hashPacket(const byte *packet, uint16_t size)
+{
+	uint32_t hash = 2166136261UL;
+
+	while ( size-- ) {
+		hash = (hash ^ *packet++) * 16777619UL;
+	}
+	return hash;
+}
+
+static bool sameRequest(const SNMP_REQUEST_KEY *a, const SNMP_REQUEST_KEY *b)
+{
+	return a->requestId == b->requestId && a->hash == b->hash && a->port == b->port
+		&& memcmp(a->ip, b->ip, 4) == 0;
+}
+
+/**
+ * @brief Answer a retransmitted request with the response sent for it
+ *	  before. Otherwise the request is remembered, so that responsePdu()
+ *	  can keep its answer.
+ * @param void
+ * @return - true if the request was answered from the cache.
+ */ 
+bool AgentuinoClass::replayResponse(void)
+{
+#if SNMP_RESPONSE_CACHE_SIZE
+	SNMP_REQUEST_KEY *key = &_requestKey;
+	uint32_t now;
+
+	_requestKeyed = false;
+	if ( _cacheLifetime == 0 || _packetSize > SNMP_MAX_PACKET_LEN ) return false;
+	readPacket();
+	if ( !peekRequestId(_packet, _packetSize, &key->requestId) ) return false;
+	memcpy(key->ip, _dstIp, 4);
+	key->port = _dstPort;
+	key->hash = hashPacket(_packet, _packetSize);
+	_requestKeyed = true;
+	//
+	now = millis();
+	for ( uint8_t i = 0; i < SNMP_RESPONSE_CACHE_SIZE; i++ ) {
+		SNMP_CACHED_RESPONSE *entry = _responses + i;
+
+		if ( entry->data == NULL || !sameRequest(&entry->key, key) ) continue;
+		if ( now - entry->sent >= _cacheLifetime ) {
+			SNMP_FREE(entry->data);
+			break;
+		}
+		_requestKeyed = false;
+		_cacheHits++;
+		_transport->send(_dstIp, _dstPort, entry->data, entry->size);
+		return true;
+	}
+	_cacheMisses++;
+#endif
+	return false;
+}
+
+/**
+ * @brief Keep the response just sent for the pending request. A free or
+ *	  expired slot is preferred, otherwise the slots are reused in turn.
+ * @param void
+ * @return void
+ */ 
+void AgentuinoClass::storeResponse(void)
+{
+#if SNMP_RESPONSE_CACHE_SIZE
+	SNMP_CACHED_RESPONSE *entry = NULL;
+	uint32_t now = millis();
+	byte *data;
+
+	if ( !_requestKeyed ) return;
+	_requestKeyed = false;
+	for ( uint8_t i = 0; i < SNMP_RESPONSE_CACHE_SIZE && entry == NULL; i++ ) {
+		if ( _responses[i].data == NULL || now - _responses[i].sent >= _cacheLifetime ) {
+			entry = _responses + i;
+		}
+	}
+	if ( entry == NULL ) {
+		entry = _responses + _responseNext;
+		_responseNext = (_responseNext + 1) % SNMP_RESPONSE_CACHE_SIZE;
+	}
+	data = (byte *) realloc(entry->data, _packetSize);
+	if ( data == NULL ) {
+		SNMP_FREE(entry->data);
+		return;
+	}
+	memcpy(data, _packet + _packetPos, _packetSize);
+	entry->data = data;
+	entry->size = _packetSize;
+	entry->key = _requestKey;
+	entry->sent = now;
+#endif
+}
+
+/**
+ * @brief Validate a request message in one pass and point the view into it.
+ *	  Every variable binding is checked here, so varBinds() can walk them
+ *	  without further validation.
+ * @param packet - The received message, must outlive the view.
+ * @param size - Bytes in packet.
+ * @return - The API status code.
+ */ 
+SNMP_API_STAT_CODES SNMP_PDU_VIEW::parse(const byte *packet, uint16_t size)
+{
+	uint16_t pos = 0, end, len;
+	byte tag;
+
+	varBindCount = 0;
+	varBindList.data = NULL;
+	varBindList.size = 0;
+	//
+	// message sequence
+	if ( !readHeader(packet, size, &pos, &tag, &len) || tag != SNMP_SYNTAX_SEQUENCE ) {
+		return SNMP_API_STAT_PACKET_INVALID;
+	}
+	end = pos + len;
+	//
+	// version
+	if ( !readInteger(packet, end, &pos, &version) ) {
+		return SNMP_API_STAT_PACKET_INVALID;
+	}
+	//
+	// community string
+	if ( !readHeader(packet, end, &pos, &tag, &len) || tag != SNMP_SYNTAX_OCTETS ) {
+		return SNMP_API_STAT_PACKET_INVALID;
+	}
+	community.data = packet + pos;
+	community.size = len;
+	pos += len;
+	//
+	// pdu-type
+	if ( !readHeader(packet, end, &pos, &tag, &len) ) {
+		return SNMP_API_STAT_PACKET_INVALID;
+	}
+	type = (SNMP_PDU_TYPES)tag;
+	end = pos + len;
+	//
+	// request-id, error and error-index
+	if ( !readInteger(packet, end, &pos, &requestId)
+		|| !readInteger(packet, end, &pos, &error)
+		|| !readInteger(packet, end, &pos, &errorIndex) ) {
+		return SNMP_API_STAT_PACKET_INVALID;
+	}
+	//
+	// variable bindings
+	if ( !readHeader(packet, end, &pos, &tag, &len) || tag != SNMP_SYNTAX_SEQUENCE ) {
+		return SNMP_API_STAT_PACKET_INVALID;
+	}
+	varBindList.data = packet + pos;
+	varBindList.size = len;
+	end = pos + len;
+	while ( pos < end ) {
+		uint16_t vbEnd;
+
+		if ( !readHeader(packet, end, &pos, &tag, &len) || tag != SNMP_SYNTAX_SEQUENCE ) {
+			return SNMP_API_STAT_PACKET_INVALID;
+		}
+		vbEnd = pos + len;
+		if ( !readHeader(packet, vbEnd, &pos, &tag, &len) || tag != SNMP_SYNTAX_OID ) {
+			return SNMP_API_STAT_PACKET_INVALID;
+		}
+		pos += len;
+		if ( !readHeader(packet, vbEnd, &pos, &tag, &len) || pos + len != vbEnd ) {
+			return SNMP_API_STAT_PACKET_INVALID;
+		}
+		pos = vbEnd;
+		varBindCount++;
+	}
+	//
+	return SNMP_API_STAT_SUCCESS;
+}
+
+// the list was validated by SNMP_PDU_VIEW::parse(), only the headers are read again
+bool SNMP_VARBIND_ITERATOR::next(SNMP_VARBIND_VIEW *vb)
+{
+	uint16_t p = 0, vbEnd, len;
+	byte tag;
+
+	if ( pos >= end ) return false;
+	if ( !readHeader(pos, end - pos, &p, &tag, &len) ) return false;
+	vbEnd = p + len;
+	if ( !readHeader(pos, vbEnd, &p, &tag, &len) ) return false;
+	vb->oid.data = pos + p;
+	vb->oid.size = len;
+	p += len;
+	if ( !readHeader(pos, vbEnd, &p, &tag, &len) ) return false;
+	vb->syntax = (SNMP_SYNTAXES)tag;
+	vb->value.data = pos + p;
+	vb->value.size = len;
+	pos += vbEnd;
+	return true;
+}
+
+/**
+ * @brief Finish a message around the pdu contents already in ber: pdu-type,
+ *	  community, version and the message sequence. _packetPos/_packetSize
+ *	  are set to the encoded message inside _packet.
+ * @param ber - Writer holding exactly the pdu contents.
+ * @param type - PDU tag.
+ * @param version - SNMP version of the message.
+ * @param community - Community name, NULL for the one of the pdu type.
+ * @return void
+ */ 
+void AgentuinoClass::writeHeaders(SNMP_BER_WRITER *ber, byte type, int32_t version,
+				  const char *community)
+{
+	if ( community == NULL ) {
+		if ( _dstType == SNMP_PDU_SET ) {
+			community = _setCommName;
+		} else if ( _dstType == SNMP_PDU_TRAP ) {
+			community = _trapCommName;
+		} else {
+			community = _getCommName;
+		}
+	}
+	//
+	// SNMP PDU
+	ber->close(type, 0);
+	//
+	// SNMP community string
+	ber->writeTLV(SNMP_SYNTAX_OCTETS, (const byte *)community, strlen(community));
+	//
+	// SNMP version
+	ber->writeInteger(SNMP_SYNTAX_INT, version);
+	//
+	// entire SNMP packet
+	ber->close(SNMP_SYNTAX_SEQUENCE, 0);
+	_packetPos = ber->pos;
+	_packetSize = ber->size();
+}
+
+/**
+ * @brief Encode and send the response to the last request with all of its
+ *	  variable bindings. A response that does not fit the packet buffer
+ *	  is sent as tooBig with an empty variable binding list.
+ * @param pdu - Response, varBindCount bindings are encoded.
+ * @return - The API status code.
+ */ 
+SNMP_API_STAT_CODES AgentuinoClass::responsePdu(SNMP_PDU *pdu)
+{
+	SNMP_API_STAT_CODES status;
+	SNMP_BER_WRITER ber;
+	uint8_t count = pdu->varBindCount;
+
+	for ( ;; ) {
+		ber.begin(_packet, SNMP_MAX_PACKET_LEN);
+		//
+		// Varbind List, last binding first
+		for ( uint8_t i = count; i-- > 0; ) {
+			pdu->varBinds[i].encode(&ber);
+		}
+		ber.close(SNMP_SYNTAX_SEQUENCE, 0);
+		//
+		// Error Index, Error and Request ID
+		ber.writeInteger(SNMP_SYNTAX_INT, pdu->errorIndex);
+		ber.writeInteger(SNMP_SYNTAX_INT, (int32_t)pdu->error);
+		ber.writeInteger(SNMP_SYNTAX_INT, pdu->requestId);
+		this->writeHeaders(&ber, pdu->type, pdu->version);
+		if ( !ber.overflow || count == 0 ) break;
+		//
+		// does not fit the packet buffer, answer tooBig without bindings
+		pdu->error = SNMP_ERR_TOO_BIG;
+		pdu->errorIndex = 0;
+		count = 0;
+	}
+	if ( ber.overflow ) {
+		return SNMP_API_STAT_PACKET_TOO_BIG;
+	}
+	status = writePacket(_dstIp, _dstPort);
+	if ( status == SNMP_API_STAT_SUCCESS ) {
+		storeResponse();
+	}
+	return status;
+}
+
+SNMP_API_STAT_CODES AgentuinoClass::writePacket(
+        const uint8_t *address, uint16_t port)
+{
+	// encoders fill _packet back to front, the message starts at _packetPos
+	return _transport->send(address, port, _packet + _packetPos, _packetSize);
+}
+
+void AgentuinoClass::onPduReceive(onPduReceiveCallback pduReceived)
+{
+	_callback = pduReceived;
+}
+
+/**
+ * @brief Replace the default datagram transport. Must be called before begin().
+ * @param transport - Pointer to a transport that outlives the agent.
+ * @return void
+ */ 
+void AgentuinoClass::setTransport(AgentuinoTransport *transport)
+{
+	if ( _ownTransport ) {
+		delete _transport;
+		_ownTransport = false;
+	}
+	_transport = transport;
+}
+
+void AgentuinoClass::freePdu(SNMP_PDU *pdu)
+{
+	// only the sizes are reset, every decoder and encoder honours them.
+	// pdu is owned by the caller (usually on its stack), never free() it here
+	pdu->varBindCount = 0;
+	pdu->OID.size = 0;
+	pdu->VALUE.size = 0;
+}
+
+SNMP_API_STAT_CODES AgentuinoClass::addVarToBindList(VAR_BIND_LIST *bindList, 
+						    const char *oid, void *variable,
+						    SNMP_SYNTAXES type)
+{
+	char text[SNMP_MAX_OID_LEN];
+	SNMP_OID rawOID;
+	VAR_BIND_LIST *newVar;
+
+	// the text is converted once, the BER form is kept right behind the node
+	if(strlen_P((PGM_P) oid) >= SNMP_MAX_OID_LEN)
+		return SNMP_API_STAT_OID_TOO_BIG;
+	strcpy_P(text, (PGM_P) oid);
+	if(rawOID.fromString(text) != SNMP_ERR_NO_ERROR)
+		return SNMP_API_STAT_OID_INVALID;
+	newVar = (VAR_BIND_LIST *) malloc(sizeof(VAR_BIND_LIST) + rawOID.size);
+
+	if(newVar != NULL)
+	{
+		byte *berOid = (byte *) (newVar + 1);
+
+		memcpy(berOid, rawOID.data, rawOID.size);
+		newVar->var = variable;
+		newVar->type = type;
+		strcpy(newVar->oid, text);
+		newVar->berOid = berOid;
+		newVar->berOidSize = rawOID.size;
+		newVar->nextVar = bindList->nextVar;
+		bindList->nextVar = newVar;
+	}
+	else
+		return SNMP_API_STAT_MALLOC_ERR;
+	
+	return SNMP_API_STAT_SUCCESS;
+
+}
+
+/**
+ * @brief Append a variable to a trap variable binding list.
+ * @param bindList - Head of the list.
+ * @param oid - BER encoded OID (e.g. SNMP_OID_BER(1,3,6,...)), must outlive the list.
+ * @param oidSize - Number of bytes in oid.
+ * @param variable - Variable sent with the trap.
+ * @param type - Syntax of variable.
+ * @return - The API status code.
+ */ 
+SNMP_API_STAT_CODES AgentuinoClass::addVarToBindList(VAR_BIND_LIST *bindList,
+						    const byte *oid, uint8_t oidSize,
+						    void *variable, SNMP_SYNTAXES type)
+{
+	VAR_BIND_LIST *newVar = (VAR_BIND_LIST *) malloc(sizeof(VAR_BIND_LIST));
+
+	if(newVar == NULL)
+		return SNMP_API_STAT_MALLOC_ERR;
+
+	newVar->var = variable;
+	newVar->type = type;
+	newVar->oid[0] = '\0';
+	newVar->berOid = oid;
+	newVar->berOidSize = oidSize;
+	newVar->nextVar = bindList->nextVar;
+	bindList->nextVar = newVar;
+
+	return SNMP_API_STAT_SUCCESS;
+}
+// Create one global object
+AgentuinoClass Agentuino;
+
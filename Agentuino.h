@@ -1,679 +1,1414 @@
-/*
-  Agentuino - An Arduino library for a lightweight SNMP Agent.
-  Copyright (C) 2010 Eric C. Gionet <lavco_eg@hotmail.com>
-  All rights reserved.
-  This library is free software; you can redistribute it and/or
-  modify it under the terms of the GNU Lesser General Public
-  License as published by the Free Software Foundation; either
-  version 2.1 of the License, or (at your option) any later version.
-  This library is distributed in the hope that it will be useful,
-  but WITHOUT ANY WARRANTY; without even the implied warranty of
-  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
-  Lesser General Public License for more details.
-  You should have received a copy of the GNU Lesser General Public
-  License along with this library; if not, write to the Free Software
-  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
-*/
-
-// Update fromString by Petr Domorazek
-// installTraps, addVarBindList, trapWatcher by Luck21
-
-#ifndef Agentuino_h
-#define Agentuino_h
-
-
-#define SNMP_DEFAULT_PORT	161
-#define SNMP_MIN_OID_LEN	2
-#define SNMP_MAX_OID_LEN	64 // 128
-#define SNMP_MAX_NAME_LEN	20
-#define SNMP_MAX_VALUE_LEN      64  // 128 ??? should limit this
-#define SNMP_MAX_PACKET_LEN     SNMP_MAX_VALUE_LEN + SNMP_MAX_OID_LEN + 25  //???
-#define SNMP_FREE(s)   do { if (s) { free((void *)s); s=NULL; } } while(0)
-//Frees a pointer only if it is !NULL and sets its value to NULL. 
-
-//#ifndef DO_NOT_COMPILE_TRAPS
-
-#define DO_NOT_USE_TRAPS 0
-#define USE_TRAPS 1
-#define MAX_TRAPS 3	// max number managed by the agent
-
-//#endif
-
-#include "Arduino.h"
-#include "Udp.h"
-
-extern "C" {
-	// callback function
-	typedef void (*onPduReceiveCallback)(void);
-}
-
-//typedef long long int64_t;
-typedef unsigned long long uint64_t;
-//typedef long int32_t;
-//typedef unsigned long uint32_t;
-//typedef unsigned char uint8_t;
-//typedef short int16_t;
-//typedef unsigned short uint16_t;
-
-
-typedef union uint64_u {
-	uint64_t uint64;
-	byte data[8];
-};
-
-typedef union int32_u {
-	int32_t int32;
-	byte data[4];
-};
-
-typedef union uint32_u {
-	uint32_t uint32;
-	byte data[4];
-};
-
-typedef union int16_u {
-	int16_t int16;
-	byte data[2];
-};
-
-//typedef union uint16_u {
-//	uint16_t uint16;
-//	byte data[2];
-//};
-
-typedef enum ASN_BER_BASE_TYPES {
-	//   ASN/BER base types
-	ASN_BER_BASE_UNIVERSAL 	 = 0x0,
-	ASN_BER_BASE_APPLICATION = 0x40,
-	ASN_BER_BASE_CONTEXT 	 = 0x80,
-	ASN_BER_BASE_PUBLIC 	 = 0xC0,
-	ASN_BER_BASE_PRIMITIVE 	 = 0x0,
-	ASN_BER_BASE_CONSTRUCTOR = 0x20
-};
-
-//
-// http://oreilly.com/catalog/esnmp/chapter/ch02.html Table 2-1: SMIv1 Datatypes
-typedef enum SNMP_SYNTAXES {
-	//   SNMP ObjectSyntax values
-	SNMP_SYNTAX_SEQUENCE 	       = ASN_BER_BASE_UNIVERSAL | ASN_BER_BASE_CONSTRUCTOR | 0x10,
-	//   These values are used in the "syntax" member of VALUEs
-	SNMP_SYNTAX_BOOL 	       = ASN_BER_BASE_UNIVERSAL | ASN_BER_BASE_PRIMITIVE | 1,
-	SNMP_SYNTAX_INT 	       = ASN_BER_BASE_UNIVERSAL | ASN_BER_BASE_PRIMITIVE | 2,
-	SNMP_SYNTAX_BITS 	       = ASN_BER_BASE_UNIVERSAL | ASN_BER_BASE_PRIMITIVE | 3,
-	SNMP_SYNTAX_OCTETS 	       = ASN_BER_BASE_UNIVERSAL | ASN_BER_BASE_PRIMITIVE | 4,
-	SNMP_SYNTAX_NULL 	       = ASN_BER_BASE_UNIVERSAL | ASN_BER_BASE_PRIMITIVE | 5,
-	SNMP_SYNTAX_OID		       = ASN_BER_BASE_UNIVERSAL | ASN_BER_BASE_PRIMITIVE | 6,
-	SNMP_SYNTAX_INT32 	       = SNMP_SYNTAX_INT,
-	SNMP_SYNTAX_IP_ADDRESS         = ASN_BER_BASE_APPLICATION | ASN_BER_BASE_PRIMITIVE | 0,
-	SNMP_SYNTAX_COUNTER 	       = ASN_BER_BASE_APPLICATION | ASN_BER_BASE_PRIMITIVE | 1,
-	SNMP_SYNTAX_GAUGE 	       = ASN_BER_BASE_APPLICATION | ASN_BER_BASE_PRIMITIVE | 2,
-	SNMP_SYNTAX_TIME_TICKS         = ASN_BER_BASE_APPLICATION | ASN_BER_BASE_PRIMITIVE | 3,
-	SNMP_SYNTAX_OPAQUE 	       = ASN_BER_BASE_APPLICATION | ASN_BER_BASE_PRIMITIVE | 4,
-	SNMP_SYNTAX_NSAPADDR 	       = ASN_BER_BASE_APPLICATION | ASN_BER_BASE_PRIMITIVE | 5,
-	SNMP_SYNTAX_COUNTER64 	       = ASN_BER_BASE_APPLICATION | ASN_BER_BASE_PRIMITIVE | 6,
-	SNMP_SYNTAX_UINT32 	       = ASN_BER_BASE_APPLICATION | ASN_BER_BASE_PRIMITIVE | 7,
-};
-
-typedef enum SNMP_PDU_TYPES {
-	// PDU choices
-	SNMP_PDU_GET	  = ASN_BER_BASE_CONTEXT | ASN_BER_BASE_CONSTRUCTOR | 0,
-	SNMP_PDU_GET_NEXT = ASN_BER_BASE_CONTEXT | ASN_BER_BASE_CONSTRUCTOR | 1,
-	SNMP_PDU_RESPONSE = ASN_BER_BASE_CONTEXT | ASN_BER_BASE_CONSTRUCTOR | 2,
-	SNMP_PDU_SET	  = ASN_BER_BASE_CONTEXT | ASN_BER_BASE_CONSTRUCTOR | 3,
-//	#ifndef DO_NOT_COMPILE_TRAPS
-	SNMP_PDU_TRAP	  = ASN_BER_BASE_CONTEXT | ASN_BER_BASE_CONSTRUCTOR | 4
-//	#endif
-};
-
-//#ifndef DO_NOT_COMPILE_TRAPS
-
-typedef enum SNMP_TRAP_TYPES {
-	//   Trap generic types:
-	SNMP_TRAP_COLD_START 	      = 0,
-	SNMP_TRAP_WARM_START 	      = 1,
-	SNMP_TRAP_LINK_DOWN 	      = 2,
-	SNMP_TRAP_LINK_UP 	      = 3,
-	SNMP_TRAP_AUTHENTICATION_FAIL = 4,
-	SNMP_TRAP_EGP_NEIGHBORLOSS    = 5,
-	SNMP_TRAP_ENTERPRISE_SPECIFIC = 6
-};
-
-typedef struct VAR_BIND_LIST {
-	void *var;
-	char oid[SNMP_MAX_OID_LEN];
-	SNMP_SYNTAXES type;
-	VAR_BIND_LIST *nextVar;
-};
-
-//Relational Operators
-enum relational_op {
-	LESS_THAN,	 // a < b
-	LESS_OR_EQUAL, 	 // a <= b
-	GREATER_THAN,	 // a > b
-	GREATER_OR_EQUAL, // a >= b
-	EQUAL,
-	NOT_EQUAL
-	//a is the pointed value by object_var field in TRAP
-	//b is base_measure field of TRAP
-};
-
-//Trap's trigger
-typedef struct TRAP{
-	char oid[SNMP_MAX_OID_LEN];
-	SNMP_TRAP_TYPES trapType;
-	uint16_t specificTrap;
-	SNMP_SYNTAXES objType;
-	void *object_var;
-	enum relational_op condition;
-	void *base_measure;	//value to compare
-	bool send;
-	VAR_BIND_LIST *varBindList;
-};
-//#endif
-
-typedef enum SNMP_ERR_CODES {
-	SNMP_ERR_NO_ERROR 	  		= 0,
-	SNMP_ERR_TOO_BIG 	  		= 1,
-	SNMP_ERR_NO_SUCH_NAME 			= 2,
-	SNMP_ERR_BAD_VALUE 	  		= 3,
-	SNMP_ERR_READ_ONLY 	  		= 4,
-	SNMP_ERR_GEN_ERROR 	  		= 5,
-
-	SNMP_ERR_NO_ACCESS	  		= 6,
-	SNMP_ERR_WRONG_TYPE   			= 7,
-	SNMP_ERR_WRONG_LENGTH 			= 8,
-	SNMP_ERR_WRONG_ENCODING			= 9,
-	SNMP_ERR_WRONG_VALUE			= 10,
-	SNMP_ERR_NO_CREATION			= 11,
-	SNMP_ERR_INCONSISTANT_VALUE 		= 12,
-	SNMP_ERR_RESOURCE_UNAVAILABLE		= 13,
-	SNMP_ERR_COMMIT_FAILED			= 14,
-	SNMP_ERR_UNDO_FAILED			= 15,
-	SNMP_ERR_AUTHORIZATION_ERROR		= 16,
-	SNMP_ERR_NOT_WRITABLE			= 17,
-	SNMP_ERR_INCONSISTEN_NAME		= 18
-};
-
-typedef enum SNMP_API_STAT_CODES {
-	SNMP_API_STAT_SUCCESS = 0,
-	SNMP_API_STAT_MALLOC_ERR = 1,
-	SNMP_API_STAT_NAME_TOO_BIG = 2,
-	SNMP_API_STAT_OID_TOO_BIG = 3,
-	SNMP_API_STAT_VALUE_TOO_BIG = 4,
-	SNMP_API_STAT_PACKET_INVALID = 5,
-	SNMP_API_STAT_PACKET_TOO_BIG = 6,
-	SNMP_API_STAT_NO_SUCH_NAME = 7,
-};
-
-
-
-typedef struct SNMP_OID {
-	byte data[SNMP_MAX_OID_LEN];  // ushort array insted??
-	size_t size;
-	//
-	void fromString(const char *buffer) {
-		if (buffer[0] == '1' && buffer[1] == '.' && buffer[2] == '3' && buffer[3] == '.') {
-			memset(data, 0, SNMP_MAX_OID_LEN);
-			data[0] = 0x2B;			
-			int fs_ilen = strlen(buffer);
-			int fs_ic = 0;
-			int fs_id = 1;
-			char fs_Csl[5];
-			memset(fs_Csl, 0, 5);
-			for (int fs_i = 4; fs_i < fs_ilen; fs_i++){
-				if (buffer[fs_i] == '.') {
-      					word fs_oidw = atol(fs_Csl);
-      					if (fs_oidw < 128) {
-        					data[fs_id] = fs_oidw;
-					} else if (fs_oidw < 16384 ) {
-        					byte fs_loidb = lowByte(fs_oidw) & 127;
-			        		word fs_oidwtmp = fs_oidw << 1;
-        					byte fs_hoidb = highByte(fs_oidwtmp) | 128;
-			        		data[fs_id] = fs_hoidb;
-			        		fs_id++;
-        					data[fs_id] = fs_loidb;
-					} else {
-        					byte fs_loidb = lowByte(fs_oidw) & 127;
-			        		word fs_oidwtmp = fs_oidw << 1;
-        					byte fs_hoidb = highByte(fs_oidwtmp) | 128;
-						fs_oidwtmp = fs_oidw >> 14;
-						byte fs_hhoidb = (lowByte(fs_oidwtmp) & 3) | 128;
-						data[fs_id] = fs_hhoidb;
-			        		fs_id++;
-			        		data[fs_id] = fs_hoidb;
-			        		fs_id++;
-        					data[fs_id] = fs_loidb;
-					}
-		      			memset(fs_Csl, 0, 5);
-      					fs_ic = 0;
-      					fs_id++;
-      				} else {
-      					fs_Csl[fs_ic] = buffer[fs_i];
-      					fs_ic++;
-      				}
-  			}
-     			word fs_oidw = atoi(fs_Csl);
-      			if (fs_oidw < 128) {
-        			data[fs_id] = fs_oidw;
-			} else if (fs_oidw < 16384 ) {
-        			byte fs_loidb = lowByte(fs_oidw) & 127;
-			        word fs_oidwtmp = fs_oidw << 1;
-        			byte fs_hoidb = highByte(fs_oidwtmp) | 128;
-			        data[fs_id] = fs_hoidb;
-			        fs_id++;
-        			data[fs_id] = fs_loidb;
-			}  else {
-        			byte fs_loidb = lowByte(fs_oidw) & 127;
-			        word fs_oidwtmp = fs_oidw << 1;
-        			byte fs_hoidb = highByte(fs_oidwtmp) | 128;
-				fs_oidwtmp = fs_oidw >> 14;
-				byte fs_hhoidb = (lowByte(fs_oidwtmp) & 3) | 128;
-				data[fs_id] = fs_hhoidb;
-			        fs_id++;
-			        data[fs_id] = fs_hoidb;
-			        fs_id++;
-        			data[fs_id] = fs_loidb;
-			}
-
-   			fs_id++;
-			size = fs_id;
-		} 
-	}
-
-	//
-	void toString(char *buffer) {
-		buffer[0] = '1';
-		buffer[1] = '.';
-		buffer[2] = '3';
-		buffer[3] = '\0';
-		//
-		char buff[16];
-		byte hsize = size - 1;
-		byte hpos = 1;
-		uint16_t subid;
-		//
-		while ( hsize > 0 ) {
-			subid = 0;
-			uint16_t b = 0;
-			do {
-				uint16_t next = data[hpos++];
-				b = next & 0xFF;
-				subid = (subid << 7) + (b & ~0x80);
-				hsize--;
-			} while ( (hsize > 0) && ((b & 0x80) != 0) );
-			utoa(subid, buff, 10);
-			strcat(buffer, ".");
-			strcat(buffer, buff);
-		}
-	};
-};
-
-// union for values?
-//
-typedef struct SNMP_VALUE {
-	byte data[SNMP_MAX_VALUE_LEN];
-	size_t size;
-	SNMP_SYNTAXES syntax;
-	//
-	byte i; // for encoding/decoding functions
-	//
-	// clear's buffer and sets size to 0
-	void clear(void) {
-		memset(data, 0, SNMP_MAX_VALUE_LEN);
-		size = 0;
-	}
-	//
-	//
-	// ASN.1 decoding functions
-	//
-	// decode's an octet string, object-identifier, opaque syntax to string
-	SNMP_ERR_CODES decode(char *value, size_t max_size) {
-		if ( syntax == SNMP_SYNTAX_OCTETS || syntax == SNMP_SYNTAX_OID
-			|| syntax == SNMP_SYNTAX_OPAQUE ) {
-			if ( strlen(value) - 1 < max_size ) {
-				if ( syntax == SNMP_SYNTAX_OID ) {
-					value[0] = '1';
-					value[1] = '.';
-					value[2] = '3';
-					value[3] = '\0';
-					//
-					char buff[16];
-					byte hsize = size - 1;
-					byte hpos = 1;
-					uint16_t subid;
-					//
-					while ( hsize > 0 ) {
-						subid = 0;
-						uint16_t b = 0;
-						do {
-							uint16_t next = data[hpos++];
-							b = next & 0xFF;
-							subid = (subid << 7) + (b & ~0x80);
-							hsize--;
-						} while ( (hsize > 0) && ((b & 0x80) != 0) );
-						utoa(subid, buff, 10);
-						strcat(value, ".");
-						strcat(value, buff);
-					}
-				} else {
-					for ( i = 0; i < size; i++ ) {
-						value[i] = (char)data[i];
-					}
-					value[size] = '\0';
-				}
-				return SNMP_ERR_NO_ERROR;
-			} else {
-				clear();	
-				return SNMP_ERR_TOO_BIG;
-			}
-		} else {
-			clear();
-			return SNMP_ERR_WRONG_TYPE;
-		}
-	}
-	//
-	// decode's an int syntax to int16
-	SNMP_ERR_CODES decode(int16_t *value) {
-		if ( syntax == SNMP_SYNTAX_INT ) {
-			uint8_t *p = (uint8_t*)value, i;
-			memset(value, 0, sizeof(*value));
-			for(i = 0;i < size;i++)
-			{
-				*p++ = data[size - 1 - i];
-			}
-			return SNMP_ERR_NO_ERROR;
-		} else {
-			clear();
-			return SNMP_ERR_WRONG_TYPE;
-		}
-	}
-	//
-	// decode's an int32 syntax to int32
-	SNMP_ERR_CODES decode(int32_t *value) {
-		if ( syntax == SNMP_SYNTAX_INT32 ) {
-			uint8_t *p = (uint8_t*)value, i;
-			memset(value, 0, sizeof(*value));
-			for(i = 0;i < size;i++)
-			{
-				*p++ = data[size - 1 - i];
-			}
-			return SNMP_ERR_NO_ERROR;
-		} else {
-			clear();
-			return SNMP_ERR_WRONG_TYPE;
-		}
-	}
-	//
-	// decode's an uint32, counter, time-ticks, gauge syntax to uint32
-	SNMP_ERR_CODES decode(uint32_t *value) {
-		if ( syntax == SNMP_SYNTAX_COUNTER || syntax == SNMP_SYNTAX_TIME_TICKS
-			|| syntax == SNMP_SYNTAX_GAUGE || syntax == SNMP_SYNTAX_UINT32 ) {
-			uint8_t *p = (uint8_t*)value, i;
-			memset(value, 0, sizeof(*value));
-			for(i = 0;i < size;i++)
-			{
-				*p++ = data[size - 1 - i];
-			}
-			return SNMP_ERR_NO_ERROR;
-		} else {
-			clear();
-			return SNMP_ERR_WRONG_TYPE;
-		}
-	}
-	//
-	// decode's an ip-address, NSAP-address syntax to an ip-address byte array 
-	SNMP_ERR_CODES decode(byte *value) {
-		memset(data, 0, SNMP_MAX_VALUE_LEN);
-		if ( syntax == SNMP_SYNTAX_IP_ADDRESS || syntax == SNMP_SYNTAX_NSAPADDR ) {
-			uint8_t *p = (uint8_t*)value, i;
-			memset(value, 0, 4);
-			for(i = 0;i < size;i++)
-			{
-				*p++ = data[size - 4 - i];
-			}
-			return SNMP_ERR_NO_ERROR;
-		} else {
-			clear();
-			return SNMP_ERR_WRONG_TYPE;
-		}
-	}
-	//
-	// decode's a boolean syntax to boolean
-	SNMP_ERR_CODES decode(bool *value) {
-		if ( syntax == SNMP_SYNTAX_BOOL ) {
-			*value = (data[0] != 0);
-			return SNMP_ERR_NO_ERROR;
-		} else {
-			clear();
-			return SNMP_ERR_WRONG_TYPE;
-		}
-	}
-	//
-	//
-	// ASN.1 encoding functions
-	//
-	// encode's a octet string to a string, opaque syntax
-	// encode object-identifier here??
-	SNMP_ERR_CODES encode(SNMP_SYNTAXES syn, const char *value) {
-		memset(data, 0, SNMP_MAX_VALUE_LEN);
-		if ( syn == SNMP_SYNTAX_OCTETS || syn == SNMP_SYNTAX_OPAQUE ) {
-			if ( strlen(value) - 1 < SNMP_MAX_VALUE_LEN ) {
-				syntax = syn;
-				size = strlen(value);
-				for ( i = 0; i < size; i++ ) {
-					data[i] = (byte)value[i];
-				}
-				return SNMP_ERR_NO_ERROR;
-			} else {
-				clear();	
-				return SNMP_ERR_TOO_BIG;
-			}
-		} else {
-			clear();
-			return SNMP_ERR_WRONG_TYPE;
-		}
-	}
-	//
-	// encode's an int16 to int, opaque  syntax
-	SNMP_ERR_CODES encode(SNMP_SYNTAXES syn, const int16_t value) {
-		memset(data, 0, SNMP_MAX_VALUE_LEN);
-		if ( syn == SNMP_SYNTAX_INT || syn == SNMP_SYNTAX_OPAQUE ) {
-			int16_u tmp;
-			size = 2;
-			syntax = syn;
-			tmp.int16 = value;
-			data[0] = tmp.data[1];
-			data[1] = tmp.data[0];
-			return SNMP_ERR_NO_ERROR;
-		} else {
-			clear();
-			return SNMP_ERR_WRONG_TYPE;
-		}
-	}
-	//
-	// encode's an int32 to int32, opaque  syntax
-	SNMP_ERR_CODES encode(SNMP_SYNTAXES syn, const int32_t value) {
-		memset(data, 0, SNMP_MAX_VALUE_LEN);
-		if ( syn == SNMP_SYNTAX_INT32 || syn == SNMP_SYNTAX_OPAQUE ) {
-			int32_u tmp;
-			size = 4;
-			syntax = syn;
-			tmp.int32 = value;
-			data[0] = tmp.data[3];
-			data[1] = tmp.data[2];
-			data[2] = tmp.data[1];
-			data[3] = tmp.data[0];
-			return SNMP_ERR_NO_ERROR;
-		} else {
-			clear();
-			return SNMP_ERR_WRONG_TYPE;
-		}
-	}
-	//
-	// encode's an uint32 to uint32, counter, time-ticks, gauge, opaque  syntax
-	SNMP_ERR_CODES encode(SNMP_SYNTAXES syn, const uint32_t value) {
-		memset(data, 0, SNMP_MAX_VALUE_LEN);
-		if ( syn == SNMP_SYNTAX_COUNTER || syn == SNMP_SYNTAX_TIME_TICKS
-			|| syn == SNMP_SYNTAX_GAUGE || syn == SNMP_SYNTAX_UINT32 
-			|| syn == SNMP_SYNTAX_OPAQUE ) {
-			uint32_u tmp;
-			size = 4;
-			syntax = syn;
-			tmp.uint32 = value;
-			data[0] = tmp.data[3];
-			data[1] = tmp.data[2];
-			data[2] = tmp.data[1];
-			data[3] = tmp.data[0];
-			return SNMP_ERR_NO_ERROR;
-		} else {
-			clear();
-			return SNMP_ERR_WRONG_TYPE;
-		}
-	}
-	//
-	// encode's an ip-address byte array to ip-address, NSAP-address, opaque  syntax
-	SNMP_ERR_CODES encode(SNMP_SYNTAXES syn, const byte *value) {
-		memset(data, 0, SNMP_MAX_VALUE_LEN);
-		if ( syn == SNMP_SYNTAX_IP_ADDRESS || syn == SNMP_SYNTAX_NSAPADDR 
-			|| syn == SNMP_SYNTAX_OPAQUE ) {
-			if ( sizeof(value) > 4 ) {
-				clear();
-				return SNMP_ERR_TOO_BIG;
-			} else {
-				size = 4;
-				syntax = syn;
-				data[0] = value[3];
-				data[1] = value[2];
-				data[2] = value[1];
-				data[3] = value[0];
-				return SNMP_ERR_NO_ERROR;
-			}
-		} else {
-			clear();
-			return SNMP_ERR_WRONG_TYPE;
-		}
-	}
-	//
-	// encode's a boolean to boolean, opaque  syntax
-	SNMP_ERR_CODES encode(SNMP_SYNTAXES syn, const bool value) {
-		memset(data, 0, SNMP_MAX_VALUE_LEN);
-		if ( syn == SNMP_SYNTAX_BOOL || syn == SNMP_SYNTAX_OPAQUE ) {
-			size = 1;
-			syntax = syn;
-			data[0] = value ? 0xff : 0;
-			return SNMP_ERR_NO_ERROR;
-		} else {
-			clear();
-			return SNMP_ERR_WRONG_TYPE;
-		}
-	}
-	//
-	// encode's an uint64 to counter64, opaque  syntax
-	SNMP_ERR_CODES encode(SNMP_SYNTAXES syn, const uint64_t value) {
-		memset(data, 0, SNMP_MAX_VALUE_LEN);
-		if ( syn == SNMP_SYNTAX_COUNTER64 || syn == SNMP_SYNTAX_OPAQUE ) {
-			uint64_u tmp;
-			size = 8;
-			syntax = syn;
-			tmp.uint64 = value;
-			data[0] = tmp.data[7];
-			data[1] = tmp.data[6];
-			data[2] = tmp.data[5];
-			data[3] = tmp.data[4];
-			data[4] = tmp.data[3];
-			data[5] = tmp.data[2];
-			data[6] = tmp.data[1];
-			data[7] = tmp.data[0];
-			return SNMP_ERR_NO_ERROR;
-		} else {
-			clear();
-			return SNMP_ERR_WRONG_TYPE;
-		}
-	}
-	//
-	// encode's a null to null, opaque  syntax
-	SNMP_ERR_CODES encode(SNMP_SYNTAXES syn) {
-		clear();
-		if ( syn == SNMP_SYNTAX_NULL || syn == SNMP_SYNTAX_OPAQUE ) {
-			size = 0;
-			syntax = syn;
-			return SNMP_ERR_NO_ERROR;
-		} else {
-			return SNMP_ERR_WRONG_TYPE;
-		}
-	}
-};
-
-typedef struct SNMP_PDU {
-	SNMP_PDU_TYPES type;
-	int32_t version;
-	int32_t requestId;
-	SNMP_ERR_CODES error;
-	int32_t errorIndex;
-	SNMP_OID OID;
-	byte* address;
-    	uint32_t time_ticks;
-//    	#ifndef DO_NOT_COMPILE_TRAPS
-    	int16_t trap_type;
-    	int16_t specific_trap;
-    	int16_t trap_data_size;
-    	byte *trap_data;
-   	// void (*trap_data_adder)(byte*) ;
-//	#endif
-
-	SNMP_VALUE VALUE;
-};
-
-class AgentuinoClass {
-public:
-	uint32_t time_ticks = 0;
-	// Agent functions
-	SNMP_API_STAT_CODES begin(bool useTraps, uint8_t *nms);
-	SNMP_API_STAT_CODES begin(const char *getCommName,
-            const char *setCommName, const char *trapCommName, size_t num, uint8_t *nms, uint16_t port);
-	void listen(void);
-	SNMP_API_STAT_CODES requestPdu(SNMP_PDU *pdu);
-	SNMP_API_STAT_CODES responsePdu(SNMP_PDU *pdu);
-//	#ifndef DO_NOT_COMPILE_TRAPS
-	uint8_t installTrap(TRAP *trap);
-	uint8_t installTrap (const char *oid, SNMP_TRAP_TYPES trapType, uint16_t specific,
-			     void *obj, SNMP_SYNTAXES objType,
-			     enum relational_op rel_op, void *base_measure,
-			     VAR_BIND_LIST *varBindList);
-	uint8_t trapWatcher(void);
-	SNMP_API_STAT_CODES sendTrap(SNMP_PDU *pdu, const uint8_t* manager);
-//	#endif
-	void onPduReceive(onPduReceiveCallback pduReceived);
-	void freePdu(SNMP_PDU *pdu);
-
-	// Helper functions
-	SNMP_API_STAT_CODES addVarToBindList(VAR_BIND_LIST *bindList, const char *oid, void *variable, SNMP_SYNTAXES type);
-
-private:
-//	#ifndef DO_NOT_COMPILE_TRAPS
-	uint32_u NMS;
-	int8_t trapNum;
-	TRAP *trap_list;
-	uint8_t trapListSize;
-	char *_trapCommName;
-	uint16_t _packetTrapPos;
-	uint8_t checkTrapList();
-//	#endif
-    	void writeHeaders(SNMP_PDU *pdu, uint16_t size);
-    	SNMP_API_STAT_CODES writePacket(IPAddress address, uint16_t port);
-	SNMP_API_STAT_CODES mountTrapPdu(TRAP *trap, SNMP_PDU *pdu);
-	byte _packet[SNMP_MAX_PACKET_LEN];
-	uint16_t _packetSize;
-	uint16_t _packetPos;
-	SNMP_PDU_TYPES _dstType;
-	uint8_t _dstIp[4];
-	uint16_t _dstPort;
-	char *_getCommName;
-	char *_setCommName;
-	onPduReceiveCallback _callback;
-};
-
-extern AgentuinoClass Agentuino;
-// Create one global object
-//AgentuinoClass Agentuino;
-#endif
+/*
+  Agentuino - An Arduino library for a lightweight SNMP Agent.
+  Copyright (C) 2010 Eric C. Gionet <lavco_eg@hotmail.com>
+  All rights reserved.
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+// Update fromString by Petr Domorazek
+// installTraps, addVarBindList, trapWatcher by Luck21
+
+#ifndef Agentuino_h
+#define Agentuino_h
+
+
+#define SNMP_DEFAULT_PORT	161
+#define SNMP_MIN_OID_LEN	2
+#ifndef SNMP_MAX_OID_LEN
+#define SNMP_MAX_OID_LEN	64 // 128
+#endif
+#define SNMP_MAX_NAME_LEN	20
+#ifndef SNMP_MAX_VALUE_LEN
+#if defined(__AVR__)
+#define SNMP_MAX_VALUE_LEN      64  // 128 ??? should limit this
+#else
+#define SNMP_MAX_VALUE_LEN      255
+#endif
+#endif
+#ifndef SNMP_MAX_PACKET_LEN	// receive/transmit buffer, at most one UDP payload
+#if defined(__AVR__)
+#define SNMP_MAX_PACKET_LEN     (SNMP_MAX_VALUE_LEN + SNMP_MAX_OID_LEN + 25)
+#else
+#define SNMP_MAX_PACKET_LEN     1472
+#endif
+#endif
+#ifndef SNMP_MAX_VARBINDS	// variable bindings decoded per request
+#if defined(__AVR__)
+#define SNMP_MAX_VARBINDS	2
+#else
+#define SNMP_MAX_VARBINDS	32
+#endif
+#endif
+#define SNMP_FREE(s)   do { if (s) { free((void *)s); s=NULL; } } while(0)
+//Frees a pointer only if it is !NULL and sets its value to NULL. 
+
+//#ifndef DO_NOT_COMPILE_TRAPS
+
+#define DO_NOT_USE_TRAPS 0
+#define USE_TRAPS 1
+#define MAX_TRAPS 3	// max number managed by the agent
+
+//#endif
+
+#include "Arduino.h"
+#if !defined(ARDUINO)
+#include <pthread.h>
+#endif
+
+extern "C" {
+	// callback function
+	typedef void (*onPduReceiveCallback)(void);
+}
+
+//typedef long long int64_t;
+//typedef unsigned long long uint64_t;
+//typedef long int32_t;
+//typedef unsigned long uint32_t;
+//typedef unsigned char uint8_t;
+//typedef short int16_t;
+//typedef unsigned short uint16_t;
+
+
+typedef union uint64_u {
+	uint64_t uint64;
+	byte data[8];
+};
+
+typedef union int32_u {
+	int32_t int32;
+	byte data[4];
+};
+
+typedef union uint32_u {
+	uint32_t uint32;
+	byte data[4];
+};
+
+typedef union int16_u {
+	int16_t int16;
+	byte data[2];
+};
+
+//typedef union uint16_u {
+//	uint16_t uint16;
+//	byte data[2];
+//};
+
+typedef enum ASN_BER_BASE_TYPES {
+	//   ASN/BER base types
+	ASN_BER_BASE_UNIVERSAL 	 = 0x0,
+	ASN_BER_BASE_APPLICATION = 0x40,
+	ASN_BER_BASE_CONTEXT 	 = 0x80,
+	ASN_BER_BASE_PUBLIC 	 = 0xC0,
+	ASN_BER_BASE_PRIMITIVE 	 = 0x0,
+	ASN_BER_BASE_CONSTRUCTOR = 0x20
+};
+
+//
+// http://oreilly.com/catalog/esnmp/chapter/ch02.html Table 2-1: SMIv1 Datatypes
+typedef enum SNMP_SYNTAXES {
+	//   SNMP ObjectSyntax values
+	SNMP_SYNTAX_SEQUENCE 	       = ASN_BER_BASE_UNIVERSAL | ASN_BER_BASE_CONSTRUCTOR | 0x10,
+	//   These values are used in the "syntax" member of VALUEs
+	SNMP_SYNTAX_BOOL 	       = ASN_BER_BASE_UNIVERSAL | ASN_BER_BASE_PRIMITIVE | 1,
+	SNMP_SYNTAX_INT 	       = ASN_BER_BASE_UNIVERSAL | ASN_BER_BASE_PRIMITIVE | 2,
+	SNMP_SYNTAX_BITS 	       = ASN_BER_BASE_UNIVERSAL | ASN_BER_BASE_PRIMITIVE | 3,
+	SNMP_SYNTAX_OCTETS 	       = ASN_BER_BASE_UNIVERSAL | ASN_BER_BASE_PRIMITIVE | 4,
+	SNMP_SYNTAX_NULL 	       = ASN_BER_BASE_UNIVERSAL | ASN_BER_BASE_PRIMITIVE | 5,
+	SNMP_SYNTAX_OID		       = ASN_BER_BASE_UNIVERSAL | ASN_BER_BASE_PRIMITIVE | 6,
+	SNMP_SYNTAX_INT32 	       = SNMP_SYNTAX_INT,
+	SNMP_SYNTAX_IP_ADDRESS         = ASN_BER_BASE_APPLICATION | ASN_BER_BASE_PRIMITIVE | 0,
+	SNMP_SYNTAX_COUNTER 	       = ASN_BER_BASE_APPLICATION | ASN_BER_BASE_PRIMITIVE | 1,
+	SNMP_SYNTAX_GAUGE 	       = ASN_BER_BASE_APPLICATION | ASN_BER_BASE_PRIMITIVE | 2,
+	SNMP_SYNTAX_TIME_TICKS         = ASN_BER_BASE_APPLICATION | ASN_BER_BASE_PRIMITIVE | 3,
+	SNMP_SYNTAX_OPAQUE 	       = ASN_BER_BASE_APPLICATION | ASN_BER_BASE_PRIMITIVE | 4,
+	SNMP_SYNTAX_NSAPADDR 	       = ASN_BER_BASE_APPLICATION | ASN_BER_BASE_PRIMITIVE | 5,
+	SNMP_SYNTAX_COUNTER64 	       = ASN_BER_BASE_APPLICATION | ASN_BER_BASE_PRIMITIVE | 6,
+	SNMP_SYNTAX_UINT32 	       = ASN_BER_BASE_APPLICATION | ASN_BER_BASE_PRIMITIVE | 7,
+	//   SNMPv2 exceptions, reported in place of a value
+	SNMP_SYNTAX_NO_SUCH_OBJECT     = ASN_BER_BASE_CONTEXT | ASN_BER_BASE_PRIMITIVE | 0,
+	SNMP_SYNTAX_NO_SUCH_INSTANCE   = ASN_BER_BASE_CONTEXT | ASN_BER_BASE_PRIMITIVE | 1,
+	SNMP_SYNTAX_END_OF_MIB_VIEW    = ASN_BER_BASE_CONTEXT | ASN_BER_BASE_PRIMITIVE | 2,
+};
+
+typedef enum SNMP_VERSIONS {
+	SNMP_VERSION_1	= 0,
+	SNMP_VERSION_2C	= 1
+};
+
+typedef enum SNMP_PDU_TYPES {
+	// PDU choices
+	SNMP_PDU_GET	  = ASN_BER_BASE_CONTEXT | ASN_BER_BASE_CONSTRUCTOR | 0,
+	SNMP_PDU_GET_NEXT = ASN_BER_BASE_CONTEXT | ASN_BER_BASE_CONSTRUCTOR | 1,
+	SNMP_PDU_RESPONSE = ASN_BER_BASE_CONTEXT | ASN_BER_BASE_CONSTRUCTOR | 2,
+	SNMP_PDU_SET	  = ASN_BER_BASE_CONTEXT | ASN_BER_BASE_CONSTRUCTOR | 3,
+//	#ifndef DO_NOT_COMPILE_TRAPS
+	SNMP_PDU_TRAP	  = ASN_BER_BASE_CONTEXT | ASN_BER_BASE_CONSTRUCTOR | 4,
+//	#endif
+	SNMP_PDU_GET_BULK = ASN_BER_BASE_CONTEXT | ASN_BER_BASE_CONSTRUCTOR | 5,
+	SNMP_PDU_INFORM	  = ASN_BER_BASE_CONTEXT | ASN_BER_BASE_CONSTRUCTOR | 6,
+	SNMP_PDU_TRAP2	  = ASN_BER_BASE_CONTEXT | ASN_BER_BASE_CONSTRUCTOR | 7,
+	// never on the wire: asks a subtree handler to check a SET binding
+	// without applying it, before any binding of the request is applied
+	SNMP_PDU_TEST_SET = 0xFF
+};
+
+//#ifndef DO_NOT_COMPILE_TRAPS
+
+typedef enum SNMP_TRAP_TYPES {
+	//   Trap generic types:
+	SNMP_TRAP_COLD_START 	      = 0,
+	SNMP_TRAP_WARM_START 	      = 1,
+	SNMP_TRAP_LINK_DOWN 	      = 2,
+	SNMP_TRAP_LINK_UP 	      = 3,
+	SNMP_TRAP_AUTHENTICATION_FAIL = 4,
+	SNMP_TRAP_EGP_NEIGHBORLOSS    = 5,
+	SNMP_TRAP_ENTERPRISE_SPECIFIC = 6
+};
+
+typedef struct VAR_BIND_LIST {
+	void *var;
+	char oid[SNMP_MAX_OID_LEN];	// text form, used when berOid is NULL
+	SNMP_SYNTAXES type;
+	VAR_BIND_LIST *nextVar;
+	const byte *berOid;		// BER encoded OID, e.g. from SNMP_OID_BER()
+	uint8_t berOidSize;
+};
+
+//Relational Operators
+enum relational_op {
+	LESS_THAN,	 // a < b
+	LESS_OR_EQUAL, 	 // a <= b
+	GREATER_THAN,	 // a > b
+	GREATER_OR_EQUAL, // a >= b
+	EQUAL,
+	NOT_EQUAL
+	//a is the pointed value by object_var field in TRAP
+	//b is base_measure field of TRAP
+};
+
+// When a trap is sent for its condition
+typedef enum SNMP_TRAP_TRIGGERS {
+	SNMP_TRAP_LEVEL = 0,	// on every trapWatcher() call while the condition holds
+	SNMP_TRAP_EDGE  = 1	// once when the condition becomes true, again only after re-arm
+} SNMP_TRAP_TRIGGERS;
+
+// What trapWatcher() compares against base_measure, each call is one sample
+typedef enum SNMP_TRAP_MEASURES {
+	SNMP_TRAP_VALUE   = 0,	// the value itself
+	SNMP_TRAP_DELTA   = 1,	// change since the previous sample
+	SNMP_TRAP_RATE    = 2,	// change per second over the window
+	SNMP_TRAP_AVERAGE = 3,	// moving average over the window
+	SNMP_TRAP_MIN     = 4,	// smallest value in the window
+	SNMP_TRAP_MAX     = 5	// largest value in the window
+} SNMP_TRAP_MEASURES;
+
+#ifndef SNMP_TRAP_WINDOW		// max samples per trap for rate/average/min/max
+#if defined(__AVR__)
+#define SNMP_TRAP_WINDOW	4
+#else
+#define SNMP_TRAP_WINDOW	8
+#endif
+#endif
+
+// Per trap sample window, updated in O(1) by each trapWatcher() call. For
+// rate and average the ring holds deltas or values with their running sum,
+// for min/max it is a monotonic queue of (value, sample number).
+typedef struct SNMP_TRAP_SAMPLES {
+	int64_t last;			// previous sample
+	uint32_t lastTime;		// millis() of the previous sample
+	uint32_t samples;		// samples taken since install
+	int64_t sum;			// sum of value[] (rate, average), unsigned for COUNTER64
+	uint8_t carry;			// COUNTER64: times sum went past 2^64
+	uint32_t span;			// sum of time[] in ms (rate)
+	int64_t value[SNMP_TRAP_WINDOW];
+	uint32_t time[SNMP_TRAP_WINDOW];
+	uint8_t first;			// oldest slot
+	uint8_t count;			// slots in use
+};
+
+//Trap's trigger
+typedef struct TRAP{
+	char oid[SNMP_MAX_OID_LEN];
+	SNMP_TRAP_TYPES trapType;
+	uint16_t specificTrap;
+	SNMP_SYNTAXES objType;
+	void *object_var;
+	enum relational_op condition;
+	void *base_measure;	//value to compare
+	bool send;
+	VAR_BIND_LIST *varBindList;
+	const byte *berOid;		// BER encoded trap OID, NULL to encode oid once at install
+	uint8_t berOidSize;
+	bool ownsOid;			// berOid was encoded by installTrap(), freed by clearTraps()
+	byte *varOids;			// BER OIDs of the text bindings, set by installTrap()
+	SNMP_TRAP_TRIGGERS trigger;
+	// edge trigger re-arms once the condition no longer holds against this
+	// value (hysteresis band), NULL to re-arm against base_measure
+	void *rearm_measure;
+	uint32_t holdOff;		// min ms between two traps of this entry, 0 for none
+	SNMP_TRAP_MEASURES measure;
+	uint8_t window;			// samples for rate/average/min/max, 0 for SNMP_TRAP_WINDOW
+	// state kept by trapWatcher(), set by installTrap()
+	bool armed;
+	bool sent;
+	uint32_t lastSent;
+	SNMP_TRAP_SAMPLES samples;
+	// enterprise, agent-addr, generic and specific trap encoded once by
+	// installTrap(), sending only adds the time stamp and the bindings.
+	// The snmpTrapOID.0 binding of v2 notifications follows right behind.
+	byte *header;
+	uint8_t headerSize;
+	uint8_t addrPos;		// agent-addr bytes in header, refreshed per trap
+	uint8_t notifySize;		// snmpTrapOID.0 binding after headerSize
+};
+//#endif
+
+typedef enum SNMP_ERR_CODES {
+	SNMP_ERR_NO_ERROR 	  		= 0,
+	SNMP_ERR_TOO_BIG 	  		= 1,
+	SNMP_ERR_NO_SUCH_NAME 			= 2,
+	SNMP_ERR_BAD_VALUE 	  		= 3,
+	SNMP_ERR_READ_ONLY 	  		= 4,
+	SNMP_ERR_GEN_ERROR 	  		= 5,
+
+	SNMP_ERR_NO_ACCESS	  		= 6,
+	SNMP_ERR_WRONG_TYPE   			= 7,
+	SNMP_ERR_WRONG_LENGTH 			= 8,
+	SNMP_ERR_WRONG_ENCODING			= 9,
+	SNMP_ERR_WRONG_VALUE			= 10,
+	SNMP_ERR_NO_CREATION			= 11,
+	SNMP_ERR_INCONSISTANT_VALUE 		= 12,
+	SNMP_ERR_RESOURCE_UNAVAILABLE		= 13,
+	SNMP_ERR_COMMIT_FAILED			= 14,
+	SNMP_ERR_UNDO_FAILED			= 15,
+	SNMP_ERR_AUTHORIZATION_ERROR		= 16,
+	SNMP_ERR_NOT_WRITABLE			= 17,
+	SNMP_ERR_INCONSISTEN_NAME		= 18
+};
+
+typedef enum SNMP_API_STAT_CODES {
+	SNMP_API_STAT_SUCCESS = 0,
+	SNMP_API_STAT_MALLOC_ERR = 1,
+	SNMP_API_STAT_NAME_TOO_BIG = 2,
+	SNMP_API_STAT_OID_TOO_BIG = 3,
+	SNMP_API_STAT_VALUE_TOO_BIG = 4,
+	SNMP_API_STAT_PACKET_INVALID = 5,
+	SNMP_API_STAT_PACKET_TOO_BIG = 6,
+	SNMP_API_STAT_NO_SUCH_NAME = 7,
+	SNMP_API_STAT_SOCKET_ERR = 8,
+	SNMP_API_STAT_OID_INVALID = 9,
+	SNMP_API_STAT_MIB_FROZEN = 10,
+};
+
+
+
+//
+// Compile-time OID literals. The arcs are template arguments, the BER bytes
+// are produced by the compiler, e.g.
+//
+//   typedef SNMP_OID_LITERAL<1,3,6,1,2,1,1,3,0> sysUpTimeOid;
+//   Agentuino.addObject(sysUpTimeOid::data, sizeof(sysUpTimeOid::data), ...);
+//   Agentuino.addObject(SNMP_OID_BER(1,3,6,1,2,1,1,3,0), ...);
+//
+template <byte... B>
+struct SNMP_BER_BYTES {
+	static const byte data[sizeof...(B)];
+	static const uint8_t size = sizeof...(B);
+};
+template <byte... B>
+const byte SNMP_BER_BYTES<B...>::data[sizeof...(B)] = { B... };
+
+template <byte... B>
+const uint8_t SNMP_BER_BYTES<B...>::size;
+
+// prepends the higher base 128 digits of V, continuation bit set, to Tail
+template <uint32_t V, typename Tail>
+struct SNMP_BER_HIGH;
+template <uint32_t V, byte... T>
+struct SNMP_BER_HIGH<V, SNMP_BER_BYTES<T...> > {
+	typedef typename SNMP_BER_HIGH<V / 128, SNMP_BER_BYTES<(byte)(0x80 | (V % 128)), T...> >::type type;
+};
+template <byte... T>
+struct SNMP_BER_HIGH<0, SNMP_BER_BYTES<T...> > {
+	typedef SNMP_BER_BYTES<T...> type;
+};
+
+// prepends sub-identifier A to Tail
+template <uint32_t A, typename Tail>
+struct SNMP_BER_ARC;
+template <uint32_t A, byte... T>
+struct SNMP_BER_ARC<A, SNMP_BER_BYTES<T...> > {
+	typedef typename SNMP_BER_HIGH<A / 128, SNMP_BER_BYTES<(byte)(A % 128), T...> >::type type;
+};
+
+// encodes the sub-identifiers Arcs in front of Tail
+template <typename Tail, uint32_t... Arcs>
+struct SNMP_BER_ARCS {
+	typedef Tail type;
+};
+template <typename Tail, uint32_t A, uint32_t... R>
+struct SNMP_BER_ARCS<Tail, A, R...> {
+	typedef typename SNMP_BER_ARC<A, typename SNMP_BER_ARCS<Tail, R...>::type>::type type;
+};
+
+// the first two arcs share one sub-identifier (40 * A1 + A2)
+template <uint32_t A1, uint32_t A2, uint32_t... R>
+struct SNMP_OID_LITERAL : SNMP_BER_ARCS<SNMP_BER_BYTES<>, A1 * 40 + A2, R...>::type {
+	static_assert(A1 < 2 ? A2 < 40 : A1 == 2, "first arcs must be 0.x, 1.x (x < 40) or 2.x");
+	static_assert(SNMP_BER_ARCS<SNMP_BER_BYTES<>, A1 * 40 + A2, R...>::type::size <= SNMP_MAX_OID_LEN,
+		      "OID longer than SNMP_MAX_OID_LEN");
+};
+
+// expands to the (oid, oidSize) argument pair the registry and trap functions take
+#define SNMP_OID_BER(...)	SNMP_OID_LITERAL<__VA_ARGS__>::data, SNMP_OID_LITERAL<__VA_ARGS__>::size
+
+// dotted OID text <-> BER sub-identifiers, see AgentuinoMib.cpp
+SNMP_ERR_CODES snmpOidFromText(const char *text, byte *oid, size_t max, size_t *size);
+SNMP_ERR_CODES snmpOidToText(const byte *oid, size_t size, char *text, size_t max);
+
+// text buffer always large enough for a SNMP_OID, a BER byte never adds more than 4 characters
+#define SNMP_MAX_OID_TEXT_LEN	(4 * SNMP_MAX_OID_LEN + 1)
+
+typedef struct SNMP_OID {
+	byte data[SNMP_MAX_OID_LEN];  // ushort array insted??
+	size_t size;
+	//
+	// parses dotted text with 32 bit arcs, size is 0 after an error
+	SNMP_ERR_CODES fromString(const char *buffer) {
+		return snmpOidFromText(buffer, data, SNMP_MAX_OID_LEN, &size);
+	}
+	//
+	// writes dotted text to a buffer of max bytes
+	SNMP_ERR_CODES toString(char *buffer, size_t max) const {
+		return snmpOidToText(data, size, buffer, max);
+	}
+	// buffer must hold SNMP_MAX_OID_TEXT_LEN bytes
+	void toString(char *buffer) const {
+		toString(buffer, SNMP_MAX_OID_TEXT_LEN);
+	}
+};
+
+//
+// Minimal BER integer contents. The C++ type picks signed (two's complement)
+// or unsigned encoding at compile time; only the bytes written are touched.
+template <typename T> struct SNMP_INT_TRAITS;	// no definition: unsupported type
+template <> struct SNMP_INT_TRAITS<int16_t>  { static const bool isSigned = true; };
+template <> struct SNMP_INT_TRAITS<int32_t>  { static const bool isSigned = true; };
+template <> struct SNMP_INT_TRAITS<uint32_t> { static const bool isSigned = false; };
+template <> struct SNMP_INT_TRAITS<uint64_t> { static const bool isSigned = false; };
+
+// the syntaxes a C++ type may be encoded as, checked when the syntax is a template argument
+template <SNMP_SYNTAXES S, typename T> struct SNMP_SYNTAX_ACCEPTS { static const bool value = false; };
+template <typename T> struct SNMP_SYNTAX_ACCEPTS<SNMP_SYNTAX_OPAQUE, T> { static const bool value = true; };
+template <> struct SNMP_SYNTAX_ACCEPTS<SNMP_SYNTAX_INT, int16_t> { static const bool value = true; };
+template <> struct SNMP_SYNTAX_ACCEPTS<SNMP_SYNTAX_INT, int32_t> { static const bool value = true; };
+template <> struct SNMP_SYNTAX_ACCEPTS<SNMP_SYNTAX_COUNTER, uint32_t> { static const bool value = true; };
+template <> struct SNMP_SYNTAX_ACCEPTS<SNMP_SYNTAX_GAUGE, uint32_t> { static const bool value = true; };
+template <> struct SNMP_SYNTAX_ACCEPTS<SNMP_SYNTAX_TIME_TICKS, uint32_t> { static const bool value = true; };
+template <> struct SNMP_SYNTAX_ACCEPTS<SNMP_SYNTAX_UINT32, uint32_t> { static const bool value = true; };
+template <> struct SNMP_SYNTAX_ACCEPTS<SNMP_SYNTAX_COUNTER64, uint64_t> { static const bool value = true; };
+
+// bytes of the shortest encoding of value
+template <typename T>
+inline uint8_t snmpIntegerSize(T value) {
+	uint8_t n = sizeof(T);
+	if ( SNMP_INT_TRAITS<T>::isSigned ) {
+		// drop leading bytes that only repeat the sign bit
+		while ( n > 1 ) {
+			byte top = (byte)(value >> (8 * (n - 1)));
+			byte next = (byte)(value >> (8 * (n - 2)));
+			if ( !((top == 0x00 && !(next & 0x80)) || (top == 0xFF && (next & 0x80))) ) break;
+			n--;
+		}
+		return n;
+	}
+	while ( n > 1 && (byte)(value >> (8 * (n - 1))) == 0 ) n--;
+	// a set top bit needs a leading 0 to stay positive
+	return ((byte)(value >> (8 * (n - 1))) & 0x80) ? n + 1 : n;
+}
+
+// writes the shortest encoding of value to out and returns its size
+template <typename T>
+inline uint8_t snmpEncodeInteger(byte *out, T value) {
+	uint8_t n = snmpIntegerSize(value);
+	for ( uint8_t k = n; k-- > 0; ) {
+		out[k] = (byte)value;
+		value = (T)(value >> 8);
+	}
+	return n;
+}
+
+// reads size content bytes into value, sign extended for signed types
+template <typename T>
+inline SNMP_ERR_CODES snmpDecodeInteger(const byte *in, size_t size, T *value) {
+	T v = (SNMP_INT_TRAITS<T>::isSigned && size > 0 && (in[0] & 0x80)) ? (T)-1 : 0;
+	if ( !SNMP_INT_TRAITS<T>::isSigned && size == sizeof(T) + 1 && in[0] == 0 ) {
+		in++;
+		size--;
+	}
+	if ( size == 0 || size > sizeof(T) ) {
+		return SNMP_ERR_WRONG_LENGTH;
+	}
+	for ( size_t k = 0; k < size; k++ ) {
+		v = (T)((v << 8) | in[k]);
+	}
+	*value = v;
+	return SNMP_ERR_NO_ERROR;
+}
+
+// union for values?
+//
+typedef struct SNMP_VALUE {
+	byte data[SNMP_MAX_VALUE_LEN];
+	size_t size;
+	SNMP_SYNTAXES syntax;
+	//
+	byte i; // for encoding/decoding functions
+	//
+	// clear's buffer and sets size to 0
+	void clear(void) {
+		memset(data, 0, SNMP_MAX_VALUE_LEN);
+		size = 0;
+	}
+	//
+	//
+	// ASN.1 decoding functions
+	//
+	// decode's an octet string, object-identifier, opaque syntax to string
+	SNMP_ERR_CODES decode(char *value, size_t max_size) {
+		if ( syntax == SNMP_SYNTAX_OCTETS || syntax == SNMP_SYNTAX_OID
+			|| syntax == SNMP_SYNTAX_OPAQUE ) {
+			if ( syntax == SNMP_SYNTAX_OID ) {
+				SNMP_ERR_CODES status = snmpOidToText(data, size, value, max_size);
+				if ( status != SNMP_ERR_NO_ERROR ) {
+					clear();
+				}
+				return status;
+			}
+			if ( size < max_size ) {
+				memcpy(value, data, size);
+				value[size] = '\0';
+				return SNMP_ERR_NO_ERROR;
+			} else {
+				clear();	
+				return SNMP_ERR_TOO_BIG;
+			}
+		} else {
+			clear();
+			return SNMP_ERR_WRONG_TYPE;
+		}
+	}
+	//
+	// decode's an int syntax to int16
+	SNMP_ERR_CODES decode(int16_t *value) {
+		if ( syntax == SNMP_SYNTAX_INT ) {
+			return snmpDecodeInteger(data, size, value);
+		} else {
+			clear();
+			return SNMP_ERR_WRONG_TYPE;
+		}
+	}
+	//
+	// decode's an int32 syntax to int32
+	SNMP_ERR_CODES decode(int32_t *value) {
+		if ( syntax == SNMP_SYNTAX_INT32 ) {
+			return snmpDecodeInteger(data, size, value);
+		} else {
+			clear();
+			return SNMP_ERR_WRONG_TYPE;
+		}
+	}
+	//
+	// decode's an uint32, counter, time-ticks, gauge syntax to uint32
+	SNMP_ERR_CODES decode(uint32_t *value) {
+		if ( syntax == SNMP_SYNTAX_COUNTER || syntax == SNMP_SYNTAX_TIME_TICKS
+			|| syntax == SNMP_SYNTAX_GAUGE || syntax == SNMP_SYNTAX_UINT32 ) {
+			return snmpDecodeInteger(data, size, value);
+		} else {
+			clear();
+			return SNMP_ERR_WRONG_TYPE;
+		}
+	}
+	//
+	// decode's a counter64 syntax to uint64
+	SNMP_ERR_CODES decode(uint64_t *value) {
+		if ( syntax == SNMP_SYNTAX_COUNTER64 ) {
+			return snmpDecodeInteger(data, size, value);
+		} else {
+			clear();
+			return SNMP_ERR_WRONG_TYPE;
+		}
+	}
+	//
+	// decode's an ip-address, NSAP-address syntax to an ip-address byte array 
+	SNMP_ERR_CODES decode(byte *value) {
+		if ( syntax == SNMP_SYNTAX_IP_ADDRESS || syntax == SNMP_SYNTAX_NSAPADDR ) {
+			if ( size != 4 ) {
+				return SNMP_ERR_WRONG_LENGTH;
+			}
+			memcpy(value, data, 4);
+			return SNMP_ERR_NO_ERROR;
+		} else {
+			clear();
+			return SNMP_ERR_WRONG_TYPE;
+		}
+	}
+	//
+	// decode's a boolean syntax to boolean
+	SNMP_ERR_CODES decode(bool *value) {
+		if ( syntax == SNMP_SYNTAX_BOOL ) {
+			*value = (data[0] != 0);
+			return SNMP_ERR_NO_ERROR;
+		} else {
+			clear();
+			return SNMP_ERR_WRONG_TYPE;
+		}
+	}
+	//
+	//
+	// ASN.1 encoding functions
+	//
+	// encode's an integer with the syntax fixed at compile time, e.g.
+	// value.encode<SNMP_SYNTAX_COUNTER>(count)
+	template <SNMP_SYNTAXES S, typename T>
+	SNMP_ERR_CODES encode(T value) {
+		static_assert(SNMP_SYNTAX_ACCEPTS<S, T>::value, "syntax can not hold this C++ type");
+		syntax = S;
+		size = snmpEncodeInteger(data, value);
+		return SNMP_ERR_NO_ERROR;
+	}
+	//
+	// encode's a octet string to a string, opaque syntax
+	// encode object-identifier here??
+	SNMP_ERR_CODES encode(SNMP_SYNTAXES syn, const char *value) {
+		if ( syn == SNMP_SYNTAX_OCTETS || syn == SNMP_SYNTAX_OPAQUE ) {
+			size_t len = strlen(value);
+			if ( len <= SNMP_MAX_VALUE_LEN ) {
+				syntax = syn;
+				size = len;
+				memcpy(data, value, len);
+				return SNMP_ERR_NO_ERROR;
+			} else {
+				clear();	
+				return SNMP_ERR_TOO_BIG;
+			}
+		} else {
+			clear();
+			return SNMP_ERR_WRONG_TYPE;
+		}
+	}
+	//
+	// encode's an int16 to int, opaque  syntax
+	SNMP_ERR_CODES encode(SNMP_SYNTAXES syn, const int16_t value) {
+		if ( syn == SNMP_SYNTAX_INT || syn == SNMP_SYNTAX_OPAQUE ) {
+			syntax = syn;
+			size = snmpEncodeInteger(data, value);
+			return SNMP_ERR_NO_ERROR;
+		} else {
+			clear();
+			return SNMP_ERR_WRONG_TYPE;
+		}
+	}
+	//
+	// encode's an int32 to int32, opaque  syntax
+	SNMP_ERR_CODES encode(SNMP_SYNTAXES syn, const int32_t value) {
+		if ( syn == SNMP_SYNTAX_INT32 || syn == SNMP_SYNTAX_OPAQUE ) {
+			syntax = syn;
+			size = snmpEncodeInteger(data, value);
+			return SNMP_ERR_NO_ERROR;
+		} else {
+			clear();
+			return SNMP_ERR_WRONG_TYPE;
+		}
+	}
+	//
+	// encode's an uint32 to uint32, counter, time-ticks, gauge, opaque  syntax
+	SNMP_ERR_CODES encode(SNMP_SYNTAXES syn, const uint32_t value) {
+		if ( syn == SNMP_SYNTAX_COUNTER || syn == SNMP_SYNTAX_TIME_TICKS
+			|| syn == SNMP_SYNTAX_GAUGE || syn == SNMP_SYNTAX_UINT32 
+			|| syn == SNMP_SYNTAX_OPAQUE ) {
+			syntax = syn;
+			size = snmpEncodeInteger(data, value);
+			return SNMP_ERR_NO_ERROR;
+		} else {
+			clear();
+			return SNMP_ERR_WRONG_TYPE;
+		}
+	}
+	//
+	// encode's an ip-address byte array (network order, 4 bytes) to ip-address, NSAP-address, opaque  syntax
+	SNMP_ERR_CODES encode(SNMP_SYNTAXES syn, const byte *value) {
+		if ( syn == SNMP_SYNTAX_IP_ADDRESS || syn == SNMP_SYNTAX_NSAPADDR 
+			|| syn == SNMP_SYNTAX_OPAQUE ) {
+			size = 4;
+			syntax = syn;
+			memcpy(data, value, 4);
+			return SNMP_ERR_NO_ERROR;
+		} else {
+			clear();
+			return SNMP_ERR_WRONG_TYPE;
+		}
+	}
+	//
+	// encode's a boolean to boolean, opaque  syntax
+	SNMP_ERR_CODES encode(SNMP_SYNTAXES syn, const bool value) {
+		if ( syn == SNMP_SYNTAX_BOOL || syn == SNMP_SYNTAX_OPAQUE ) {
+			size = 1;
+			syntax = syn;
+			data[0] = value ? 0xff : 0;
+			return SNMP_ERR_NO_ERROR;
+		} else {
+			clear();
+			return SNMP_ERR_WRONG_TYPE;
+		}
+	}
+	//
+	// encode's an uint64 to counter64, opaque  syntax
+	SNMP_ERR_CODES encode(SNMP_SYNTAXES syn, const uint64_t value) {
+		if ( syn == SNMP_SYNTAX_COUNTER64 || syn == SNMP_SYNTAX_OPAQUE ) {
+			syntax = syn;
+			size = snmpEncodeInteger(data, value);
+			return SNMP_ERR_NO_ERROR;
+		} else {
+			clear();
+			return SNMP_ERR_WRONG_TYPE;
+		}
+	}
+	//
+	// encode's a null to null, opaque  syntax
+	SNMP_ERR_CODES encode(SNMP_SYNTAXES syn) {
+		if ( syn == SNMP_SYNTAX_NULL || syn == SNMP_SYNTAX_OPAQUE ) {
+			size = 0;
+			syntax = syn;
+			return SNMP_ERR_NO_ERROR;
+		} else {
+			clear();
+			return SNMP_ERR_WRONG_TYPE;
+		}
+	}
+};
+
+// bytes taken by a BER definite length, long form from 128 on
+inline uint8_t snmpLengthSize(uint16_t len) {
+	return len < 0x80 ? 1 : (len < 0x100 ? 2 : 3);
+}
+
+//
+// BER writer filling a buffer from its end towards the start. Contents are
+// written before their tag and length, so the length of a constructed
+// element is simply the number of bytes written since it was opened.
+typedef struct SNMP_BER_WRITER {
+	byte *buffer;
+	uint16_t pos;		// first encoded byte
+	uint16_t end;
+	bool overflow;		// set once something did not fit, the output is then invalid
+	//
+	void begin(byte *buf, uint16_t size) {
+		buffer = buf;
+		pos = end = size;
+		overflow = false;
+	}
+	// bytes written so far, also the mark an element is closed against
+	uint16_t size(void) const {
+		return end - pos;
+	}
+	const byte *data(void) const {
+		return buffer + pos;
+	}
+	void writeByte(byte b) {
+		if ( pos == 0 ) {
+			overflow = true;
+			return;
+		}
+		buffer[--pos] = b;
+	}
+	void writeBytes(const byte *data, uint16_t len) {
+		if ( len > pos ) {
+			overflow = true;
+			pos = 0;
+			return;
+		}
+		pos -= len;
+		memcpy(buffer + pos, data, len);
+	}
+	void writeHeader(byte tag, uint16_t len) {
+		writeByte((byte)len);
+		if ( len >= 0x100 ) {
+			writeByte((byte)(len >> 8));
+			writeByte(0x82);
+		} else if ( len >= 0x80 ) {
+			writeByte(0x81);
+		}
+		writeByte(tag);
+	}
+	void writeTLV(byte tag, const byte *data, uint16_t len) {
+		writeBytes(data, len);
+		writeHeader(tag, len);
+	}
+	// shortest integer encoding, see snmpIntegerSize()
+	template <typename T>
+	void writeInteger(byte tag, T value) {
+		uint8_t n = snmpIntegerSize(value);
+		for ( uint8_t k = 0; k < n; k++ ) {
+			writeByte((byte)value);
+			value = (T)(value >> 8);
+		}
+		writeHeader(tag, n);
+	}
+	// wraps everything written after mark (an earlier size()) into a constructed element
+	void close(byte tag, uint16_t mark) {
+		writeHeader(tag, size() - mark);
+	}
+	// drops everything written after mark, e.g. to put other headers on the same contents
+	void truncate(uint16_t mark) {
+		pos = end - mark;
+		overflow = false;
+	}
+};
+
+typedef struct SNMP_VARBIND {
+	SNMP_OID OID;
+	SNMP_VALUE VALUE;
+	// complete encoded binding of a static registry object, NULL when VALUE holds the value
+	const byte *cached;
+	uint16_t cachedSize;
+	//
+	// bytes taken by the encoded binding (sequence, OID and value)
+	uint16_t encodedSize(void) {
+		if ( cached != NULL ) {
+			return cachedSize;
+		}
+		uint16_t size = 2 + snmpLengthSize(OID.size) + OID.size
+			      + snmpLengthSize(VALUE.size) + VALUE.size;
+		return 1 + snmpLengthSize(size) + size;
+	}
+	//
+	// writes the binding in front of what ber already holds
+	void encode(SNMP_BER_WRITER *ber) {
+		if ( cached != NULL ) {
+			ber->writeBytes(cached, cachedSize);
+			return;
+		}
+		uint16_t mark = ber->size();
+		ber->writeTLV((byte)VALUE.syntax, VALUE.data, VALUE.size);
+		ber->writeTLV(SNMP_SYNTAX_OID, OID.data, OID.size);
+		ber->close(SNMP_SYNTAX_SEQUENCE, mark);
+	}
+};
+
+typedef struct SNMP_PDU {
+	SNMP_PDU_TYPES type;
+	int32_t version;
+	int32_t requestId;
+	SNMP_ERR_CODES error;
+	int32_t errorIndex;	// 1-based index of the variable binding in error
+	// GET-BULK requests carry these in place of error and error-index
+	int32_t nonRepeaters;
+	int32_t maxRepetitions;
+	byte* address;
+    	uint32_t time_ticks;
+//    	#ifndef DO_NOT_COMPILE_TRAPS
+    	int16_t trap_type;
+    	int16_t specific_trap;
+    	int16_t trap_data_size;
+    	byte *trap_data;
+   	// void (*trap_data_adder)(byte*) ;
+//	#endif
+
+	uint8_t varBindCount;
+	union {
+		// OID/VALUE are the first variable binding
+		struct {
+			SNMP_OID OID;
+			SNMP_VALUE VALUE;
+		};
+		SNMP_VARBIND varBinds[SNMP_MAX_VARBINDS];
+	};
+};
+
+//
+// Zero-copy view of a request. parse() validates the message once; every field
+// is then a slice into the receive buffer, which must stay untouched while the
+// view is used.
+typedef struct SNMP_SLICE {
+	const byte *data;
+	uint16_t size;
+};
+
+typedef struct SNMP_VARBIND_VIEW {
+	SNMP_SLICE oid;		// BER encoded, without tag and length
+	SNMP_SYNTAXES syntax;
+	SNMP_SLICE value;
+};
+
+// walks the variable bindings of a parsed view, next() returns false at the end
+typedef struct SNMP_VARBIND_ITERATOR {
+	const byte *pos;
+	const byte *end;
+	//
+	bool next(SNMP_VARBIND_VIEW *vb);
+};
+
+typedef struct SNMP_PDU_VIEW {
+	int32_t version;
+	SNMP_SLICE community;
+	SNMP_PDU_TYPES type;
+	int32_t requestId;
+	int32_t error;		// non-repeaters for GET-BULK
+	int32_t errorIndex;	// max-repetitions for GET-BULK
+	SNMP_SLICE varBindList;	// contents of the variable-bindings sequence
+	uint16_t varBindCount;
+	//
+	SNMP_API_STAT_CODES parse(const byte *packet, uint16_t size);
+	SNMP_VARBIND_ITERATOR varBinds(void) const {
+		SNMP_VARBIND_ITERATOR it = { varBindList.data, varBindList.data + varBindList.size };
+		return it;
+	}
+};
+
+//
+// MIB object registry. Objects are kept sorted by their BER encoded OID so
+// GET/SET are answered with a binary search and GET-NEXT is simply the
+// following entry.
+typedef enum SNMP_ACCESS_MODES {
+	SNMP_ACCESS_READ_ONLY	= 1,
+	SNMP_ACCESS_READ_WRITE	= 3,
+	// read-only, the value never changes on its own: the encoded binding is
+	// built on the first request and reused until invalidateObject()
+	SNMP_ACCESS_STATIC	= 5
+};
+
+// value callbacks: get fills value with encode(), set receives the decoded request value
+typedef SNMP_ERR_CODES (*onGetCallback)(SNMP_VALUE *value);
+typedef SNMP_ERR_CODES (*onSetCallback)(SNMP_VALUE *value);
+
+// value of a slow source kept for ttl ticks (see AgentuinoClass::setObjectTtl())
+typedef struct SNMP_VALUE_CACHE {
+	SNMP_VALUE value;
+	uint32_t ticks;		// time_ticks of the read
+	uint32_t ttl;		// in time_ticks (10 ms)
+	bool valid;
+	uint32_t hits;
+	uint32_t misses;
+#if !defined(ARDUINO)
+	pthread_mutex_t lock;	// one read in flight when worker threads share the registry
+#endif
+};
+
+typedef struct SNMP_OBJECT {
+	const byte *oid;	// BER encoded (e.g. 0x2B, 6, 1, ...), must outlive the registry
+	uint8_t oidSize;
+	SNMP_SYNTAXES syntax;
+	SNMP_ACCESS_MODES access;
+	void *var;		// backing variable, NULL if get/set callbacks are used
+	size_t varSize;		// capacity of var for octet strings (including '\0')
+	onGetCallback get;
+	onSetCallback set;
+	byte *encoded;		// cached binding of a SNMP_ACCESS_STATIC object, owned by the registry
+	uint16_t encodedSize;
+	SNMP_VALUE_CACHE *cache;	// NULL unless a time-to-live is set, owned by the registry
+};
+
+//
+// Subtree handlers serve a whole branch (e.g. one entry per port) without
+// registering every instance. The handler receives the sub-identifiers that
+// follow the registered prefix:
+//   GET      - fill value for instance, or return SNMP_ERR_NO_SUCH_NAME
+//   SET      - apply value to instance
+//   GET-NEXT - replace instance by the first instance after it (an empty
+//              instance asks for the first one) and fill value, or return
+//              SNMP_ERR_NO_SUCH_NAME when the branch is exhausted
+#ifndef SNMP_MAX_INSTANCE_ARCS
+#define SNMP_MAX_INSTANCE_ARCS	16
+#endif
+
+typedef struct SNMP_INSTANCE {
+	uint32_t arcs[SNMP_MAX_INSTANCE_ARCS];
+	uint8_t size;
+};
+
+// type is SNMP_PDU_GET, SNMP_PDU_GET_NEXT, SNMP_PDU_SET or SNMP_PDU_TEST_SET,
+// which returns the error the SET would fail with and changes nothing
+typedef SNMP_ERR_CODES (*onSubtreeCallback)(SNMP_PDU_TYPES type, SNMP_INSTANCE *instance,
+					    SNMP_VALUE *value, void *arg);
+
+typedef struct SNMP_SUBTREE {
+	const byte *oid;	// BER encoded prefix, must outlive the registry
+	uint8_t oidSize;
+	onSubtreeCallback handler;
+	void *arg;		// passed back to handler
+};
+
+// orders two BER encoded OIDs like their sub-identifier lists
+int snmpOidCompare(const byte *a, size_t aSize, const byte *b, size_t bSize);
+
+class AgentuinoMib {
+public:
+	AgentuinoMib();
+	~AgentuinoMib();
+	SNMP_API_STAT_CODES add(const SNMP_OBJECT *object);
+	SNMP_API_STAT_CODES addSubtree(const SNMP_SUBTREE *subtree);
+	SNMP_OBJECT *find(const byte *oid, size_t size);
+	SNMP_OBJECT *next(const byte *oid, size_t size);
+	SNMP_SUBTREE *findSubtree(const byte *oid, size_t size);
+	uint16_t count(void) { return _count + _subtreeCount; }
+	// value access of an object, also used by AgentuinoTable for its cells
+	static SNMP_ERR_CODES getValue(SNMP_OBJECT *object, SNMP_VALUE *value);
+	static SNMP_ERR_CODES setValue(SNMP_OBJECT *object, SNMP_VALUE *value);
+	static SNMP_ERR_CODES checkValue(SNMP_OBJECT *object, SNMP_VALUE *value);
+	// per variable binding operations, getNext() replaces oid by the successor
+	SNMP_ERR_CODES get(SNMP_OID *oid, SNMP_VALUE *value);
+	SNMP_ERR_CODES getNext(SNMP_OID *oid, SNMP_VALUE *value);
+	SNMP_ERR_CODES set(SNMP_OID *oid, SNMP_VALUE *value);
+	// checks a SET binding without applying it
+	SNMP_ERR_CODES testSet(SNMP_OID *oid, SNMP_VALUE *value);
+	// drops the cached binding of a static object after its value changed
+	SNMP_API_STAT_CODES invalidate(const byte *oid, size_t size);
+	// keeps the value of an object for ttl time_ticks, 0 reads it on every request
+	SNMP_API_STAT_CODES setTtl(const byte *oid, size_t size, uint32_t ttl);
+	// hit and miss counts of the value cache of oid, of all objects for NULL
+	SNMP_API_STAT_CODES valueCacheStats(const byte *oid, size_t size, uint32_t *hits, uint32_t *misses);
+	// makes the registry read-only so several agents (threads) can share it
+	void freeze(void);
+	bool frozen(void) { return _frozen; }
+	// room is the number of bytes available for the response variable bindings
+	void process(SNMP_PDU *pdu, uint16_t room);
+
+private:
+	SNMP_ERR_CODES cachedValue(SNMP_OBJECT *object, SNMP_VALUE *value, uint32_t now);
+	SNMP_ERR_CODES objectBinding(SNMP_OBJECT *object, SNMP_VARBIND *vb, uint32_t now);
+	SNMP_ERR_CODES getBinding(SNMP_PDU *pdu, SNMP_VARBIND *vb);
+	SNMP_ERR_CODES subtreeGet(SNMP_OID *oid, SNMP_VALUE *value);
+	SNMP_ERR_CODES nextEntry(SNMP_OID *oid, SNMP_VALUE *value, SNMP_OBJECT **object);
+	SNMP_ERR_CODES getNextBinding(SNMP_PDU *pdu, SNMP_VARBIND *vb);
+	void processBulk(SNMP_PDU *pdu, uint16_t room);
+	SNMP_ERR_CODES subtreeNext(SNMP_SUBTREE *subtree, SNMP_INSTANCE *instance,
+				   SNMP_OID *oid, SNMP_VALUE *value);
+	SNMP_OBJECT *_objects;
+	uint16_t _count;
+	uint16_t _capacity;
+	SNMP_SUBTREE *_subtrees;
+	uint16_t _subtreeCount;
+	uint16_t _subtreeCapacity;
+	bool _frozen;
+};
+
+//
+// Conceptual tables (RFC 2578, 7.7) served from a sorted row index. The table
+// is registered at its entry OID (e.g. ifEntry) and answers the instances
+// column.index below it, where index is the sub-identifier list of a row.
+// The rows are kept ordered by their BER encoded index, so GET, GET-NEXT and
+// GET-BULK locate a row by binary search instead of walking the table.
+// Rows come from addRow() or, all at once, from an iterator with load().
+// A cell is read from / written to the row at column.offset (a backing array
+// of structs), or through the value callback when one is set.
+#ifndef SNMP_MAX_TABLE_INDEX	// bytes of a BER encoded row index
+#if defined(__AVR__)
+#define SNMP_MAX_TABLE_INDEX	8
+#else
+#define SNMP_MAX_TABLE_INDEX	32
+#endif
+#endif
+
+typedef struct SNMP_TABLE_COLUMN {
+	uint32_t id;		// sub-identifier below the entry OID, ascending
+	SNMP_SYNTAXES syntax;
+	SNMP_ACCESS_MODES access;
+	uint16_t offset;	// offsetof() the field in a row, unused with a value callback
+	uint16_t size;		// capacity of an octet string field (including '\0')
+};
+
+typedef struct SNMP_TABLE_ROW {
+	byte oid[SNMP_MAX_TABLE_INDEX];	// BER encoded index
+	uint8_t oidSize;
+	void *row;
+};
+
+// row iterator: returns the row following row (the first one for NULL) and
+// fills its index, NULL after the last row
+typedef void *(*onTableRowCallback)(void *row, SNMP_INSTANCE *index, void *arg);
+// cell callback: GET fills value with encode(), SET applies the decoded value,
+// SNMP_PDU_TEST_SET only checks it
+typedef SNMP_ERR_CODES (*onTableValueCallback)(SNMP_PDU_TYPES type, void *row,
+					       const SNMP_TABLE_COLUMN *column,
+					       SNMP_VALUE *value, void *arg);
+
+class AgentuinoTable {
+public:
+	AgentuinoTable();
+	~AgentuinoTable();
+	// columns must stay valid while the table is registered
+	SNMP_API_STAT_CODES begin(const SNMP_TABLE_COLUMN *columns, uint8_t columnCount);
+	void onValue(onTableValueCallback callback, void *arg = NULL);
+	// adding an index again replaces the row
+	SNMP_API_STAT_CODES addRow(const uint32_t *index, uint8_t indexSize, void *row);
+	SNMP_API_STAT_CODES removeRow(const uint32_t *index, uint8_t indexSize);
+	void *findRow(const uint32_t *index, uint8_t indexSize);
+	// replaces all rows by those of the iterator
+	SNMP_API_STAT_CODES load(onTableRowCallback iterator, void *arg = NULL);
+	void clear(void) { _count = 0; }
+	uint16_t rows(void) { return _count; }
+	// onSubtreeCallback, arg is the table
+	static SNMP_ERR_CODES handler(SNMP_PDU_TYPES type, SNMP_INSTANCE *instance,
+				      SNMP_VALUE *value, void *arg);
+
+private:
+	const SNMP_TABLE_COLUMN *column(uint32_t id);
+	uint16_t lookup(const uint32_t *index, uint8_t indexSize, bool *exact);
+	SNMP_ERR_CODES cell(SNMP_PDU_TYPES type, SNMP_TABLE_ROW *row,
+			    const SNMP_TABLE_COLUMN *column, SNMP_VALUE *value);
+	SNMP_ERR_CODES next(SNMP_INSTANCE *instance, SNMP_VALUE *value);
+	const SNMP_TABLE_COLUMN *_columns;
+	uint8_t _columnCount;
+	SNMP_TABLE_ROW *_rows;
+	uint16_t _count;
+	uint16_t _capacity;
+	onTableValueCallback _valueCallback;
+	void *_valueArg;
+};
+
+//
+// Datagram transport used by the agent. The Arduino build uses the Ethernet
+// shield (AgentuinoEthernet.h), the host build plain BSD sockets
+// (AgentuinoPosix.h). A custom transport can be installed with
+// AgentuinoClass::setTransport() before begin().
+class AgentuinoTransport {
+public:
+	virtual ~AgentuinoTransport() {}
+	// open the socket on the given local port
+	virtual SNMP_API_STAT_CODES begin(uint16_t port) = 0;
+	// returns the size of the next pending datagram, 0 if none
+	virtual int parsePacket(void) = 0;
+	// copies up to len bytes of the pending datagram into buffer
+	virtual int read(byte *buffer, size_t len) = 0;
+	// source address and port of the pending datagram
+	virtual void remote(uint8_t *ip, uint16_t *port) = 0;
+	virtual SNMP_API_STAT_CODES send(const uint8_t *ip, uint16_t port,
+					 const byte *buffer, size_t len) = 0;
+	// IPv4 address reported as agent-addr in traps
+	virtual void localIP(uint8_t *ip) = 0;
+	// listen() brackets each drain with these: sends in between may be
+	// queued by the transport and leave together on flush(), which then
+	// reports SNMP_API_STAT_SOCKET_ERR if any of them was refused
+	virtual void beginBatch(void) {}
+	virtual SNMP_API_STAT_CODES flush(void) { return SNMP_API_STAT_SUCCESS; }
+	// sends right away even while batching, the status is the real one
+	// (notifications, a failed one is retried from the trap queue)
+	virtual SNMP_API_STAT_CODES sendUnbatched(const uint8_t *ip, uint16_t port,
+						  const byte *buffer, size_t len) {
+		return send(ip, port, buffer, len);
+	}
+	// descriptor that becomes readable when a datagram arrives, -1 if none
+	virtual int fd(void) { return -1; }
+};
+
+//
+// Recently sent responses. A manager retransmitting a request gets the same
+// bytes again instead of running the handlers (and its SETs) a second time.
+// A request is identified by its source, its request-id and a hash of the
+// whole datagram.
+#ifndef SNMP_RESPONSE_CACHE_SIZE	// responses kept, 0 compiles the cache out
+#if defined(__AVR__)
+#define SNMP_RESPONSE_CACHE_SIZE	0
+#else
+#define SNMP_RESPONSE_CACHE_SIZE	8
+#endif
+#endif
+#ifndef SNMP_LISTEN_BUDGET		// default datagrams handled per listen()
+#define SNMP_LISTEN_BUDGET		1
+#endif
+#ifndef SNMP_RESPONSE_CACHE_MS		// default time a response is replayed
+#define SNMP_RESPONSE_CACHE_MS		5000
+#endif
+
+//
+// Traps waiting to be sent. A trap the transport did not take stays queued
+// and is retried with exponential backoff, in order, so a flapping link to
+// the NMS loses nothing until the queue is full.
+#ifndef SNMP_TRAP_QUEUE_SIZE		// pending traps, 0 compiles the queue out
+#if defined(__AVR__)
+#define SNMP_TRAP_QUEUE_SIZE	2
+#else
+#define SNMP_TRAP_QUEUE_SIZE	16
+#endif
+#endif
+#ifndef SNMP_TRAP_RETRY_MS		// first retry after a failed send
+#define SNMP_TRAP_RETRY_MS		1000
+#endif
+#ifndef SNMP_TRAP_RETRY_MAX_MS		// longest retry interval
+#define SNMP_TRAP_RETRY_MAX_MS		60000
+#endif
+#ifndef SNMP_TRAP_FILE_LEN		// room for the queue file name plus ".tmp" (host)
+#define SNMP_TRAP_FILE_LEN		256
+#endif
+
+// What a trap does to a full queue
+typedef enum SNMP_TRAP_OVERFLOW {
+	SNMP_TRAP_DROP_OLDEST = 0,	// the oldest pending trap is dropped
+	SNMP_TRAP_COALESCE    = 1	// replaces the pending one of the same entry, else drop oldest
+} SNMP_TRAP_OVERFLOW;
+
+typedef struct SNMP_QUEUED_TRAP {
+	uint32_t due;		// millis() of the next attempt
+	uint8_t attempts;	// failed sends so far
+	int8_t trap;		// entry of trap_list, -1 when loaded from the queue file
+	uint8_t ip[4];
+	uint16_t port;
+	byte *data;		// malloc'ed trap message, kept for reuse once sent
+	uint16_t size;
+	bool inform;		// waits for room in the inform window
+};
+
+//
+// Informs sent and not acknowledged yet. Up to the inform window of them are
+// in flight at once; each is sent again after the timeout until the manager
+// answers with a Response carrying its request-id, or the retries run out.
+#ifndef SNMP_MAX_INFORMS		// informs in flight, at most
+#if defined(__AVR__)
+#define SNMP_MAX_INFORMS	1
+#else
+#define SNMP_MAX_INFORMS	8
+#endif
+#endif
+#ifndef SNMP_INFORM_TIMEOUT_MS		// default time to wait for an ack
+#define SNMP_INFORM_TIMEOUT_MS	1500
+#endif
+#ifndef SNMP_INFORM_RETRIES		// default retransmissions of an inform
+#define SNMP_INFORM_RETRIES	3
+#endif
+
+typedef struct SNMP_INFORM {
+	int32_t requestId;
+	uint32_t due;		// millis() of the next retransmission
+	uint8_t retries;	// retransmissions so far
+	uint8_t ip[4];
+	uint16_t port;
+	byte *data;		// malloc'ed inform message, kept for reuse once acked
+	uint16_t size;
+	bool active;
+};
+
+//
+// Managers trapWatcher() notifies. Each trap body is encoded once per SNMP
+// version; only the message header (community, version, PDU type) is
+// written again in front of it for every target.
+#ifndef SNMP_MAX_TRAP_TARGETS		// managers a trap goes to, at most
+#if defined(__AVR__)
+#define SNMP_MAX_TRAP_TARGETS	2
+#else
+#define SNMP_MAX_TRAP_TARGETS	4
+#endif
+#endif
+
+typedef struct SNMP_TRAP_TARGET {
+	uint8_t ip[4];
+	uint16_t port;
+	char community[SNMP_MAX_NAME_LEN + 1];
+	SNMP_PDU_TYPES type;	// SNMP_PDU_TRAP, SNMP_PDU_TRAP2 or SNMP_PDU_INFORM
+};
+
+typedef struct SNMP_REQUEST_KEY {
+	uint8_t ip[4];
+	uint16_t port;
+	int32_t requestId;
+	uint32_t hash;		// FNV-1a of the request datagram
+};
+
+typedef struct SNMP_CACHED_RESPONSE {
+	SNMP_REQUEST_KEY key;
+	uint32_t sent;		// millis() when the response was sent
+	byte *data;		// malloc'ed response message, NULL for a free slot
+	uint16_t size;
+};
+
+class AgentuinoClass {
+public:
+	AgentuinoClass();
+	~AgentuinoClass();
+	uint32_t time_ticks = 0;
+	// Agent functions
+	SNMP_API_STAT_CODES begin(bool useTraps, uint8_t *nms);
+	SNMP_API_STAT_CODES begin(const char *getCommName,
+            const char *setCommName, const char *trapCommName, size_t num, uint8_t *nms, uint16_t port);
+	void listen(void);
+	// drain mode: handle up to packets pending datagrams per listen() call
+	void setListenBudget(uint8_t packets) { _listenBudget = packets ? packets : 1; }
+	// event loop integration: wait for fd() to become readable, then call processReady()
+	int fd(void) { return _transport != NULL ? _transport->fd() : -1; }
+	uint16_t processReady(void);
+	// answer from the registry of owner (objects added there), see AgentuinoWorkers
+	void shareMib(AgentuinoClass *owner);
+	AgentuinoMib *mib(void) { return _registry; }
+	// datagrams handled since begin()
+	uint32_t requestCount(void) { return _requests; }
+	// drains whose batched responses were not all accepted by the transport
+	uint32_t sendErrorCount(void) { return _sendErrors; }
+	SNMP_API_STAT_CODES requestPdu(SNMP_PDU *pdu);
+	SNMP_API_STAT_CODES requestView(SNMP_PDU_VIEW *view);
+	SNMP_API_STAT_CODES responsePdu(SNMP_PDU *pdu);
+//	#ifndef DO_NOT_COMPILE_TRAPS
+	uint8_t installTrap(TRAP *trap);
+	uint8_t installTrap (const char *oid, SNMP_TRAP_TYPES trapType, uint16_t specific,
+			     void *obj, SNMP_SYNTAXES objType,
+			     enum relational_op rel_op, void *base_measure,
+			     VAR_BIND_LIST *varBindList,
+			     SNMP_TRAP_TRIGGERS trigger = SNMP_TRAP_LEVEL,
+			     void *rearm_measure = NULL, uint32_t holdOff = 0,
+			     SNMP_TRAP_MEASURES measure = SNMP_TRAP_VALUE, uint8_t window = 0);
+	uint8_t installTrap (const byte *oid, uint8_t oidSize, SNMP_TRAP_TYPES trapType,
+			     uint16_t specific, void *obj, SNMP_SYNTAXES objType,
+			     enum relational_op rel_op, void *base_measure,
+			     VAR_BIND_LIST *varBindList,
+			     SNMP_TRAP_TRIGGERS trigger = SNMP_TRAP_LEVEL,
+			     void *rearm_measure = NULL, uint32_t holdOff = 0,
+			     SNMP_TRAP_MEASURES measure = SNMP_TRAP_VALUE, uint8_t window = 0);
+	uint8_t trapWatcher(void);
+	SNMP_API_STAT_CODES sendTrap(SNMP_PDU *pdu, const uint8_t* manager);
+	// notifications sent by trapWatcher(): SNMP_PDU_TRAP (v1, default),
+	// SNMP_PDU_TRAP2 or SNMP_PDU_INFORM (v2c)
+	SNMP_API_STAT_CODES setNotifyType(SNMP_PDU_TYPES type);
+	// managers notified instead of the NMS given to begin()
+	SNMP_API_STAT_CODES addTrapTarget(const uint8_t *ip, uint16_t port, const char *community,
+					  SNMP_PDU_TYPES type = SNMP_PDU_TRAP);
+	void clearTrapTargets(void) { _trapTargetCount = 0; }
+	uint8_t trapTargets(void) { return _trapTargetCount; }
+	void setInformWindow(uint8_t window);
+	void setInformTimeout(uint32_t ms, uint8_t retries) { _informTimeout = ms; _informRetries = retries; }
+	uint8_t pendingInforms(void) { return _informCount; }
+	uint32_t informsAcked(void) { return _informsAcked; }
+	uint32_t informsFailed(void) { return _informsFailed; }
+	// pending traps: retries that are due, overflow policy and counters
+	uint8_t flushTraps(void);
+	void setTrapOverflow(SNMP_TRAP_OVERFLOW policy) { _trapOverflow = policy; }
+	uint8_t pendingTraps(void);
+	uint32_t droppedTraps(void) { return _trapsDropped; }
+#if !defined(ARDUINO) && SNMP_TRAP_QUEUE_SIZE
+	SNMP_API_STAT_CODES setTrapQueueFile(const char *path);
+#endif
+//	#endif
+	void onPduReceive(onPduReceiveCallback pduReceived);
+	// retransmission cache: replay time in ms (0 turns it off) and its counters
+	void setResponseCacheLifetime(uint32_t ms) { _cacheLifetime = ms; }
+	uint32_t responseCacheHits(void) { return _cacheHits; }
+	uint32_t responseCacheMisses(void) { return _cacheMisses; }
+	void freePdu(SNMP_PDU *pdu);
+	void setTransport(AgentuinoTransport *transport);
+	// MIB registry, answers GET/GET-NEXT/SET when no onPduReceive callback is set
+	SNMP_API_STAT_CODES addObject(const byte *oid, size_t oidSize, SNMP_SYNTAXES syntax,
+				      SNMP_ACCESS_MODES access, void *var, size_t varSize = 0);
+	SNMP_API_STAT_CODES addObject(const byte *oid, size_t oidSize, SNMP_SYNTAXES syntax,
+				      SNMP_ACCESS_MODES access, onGetCallback get, onSetCallback set = NULL);
+	SNMP_API_STAT_CODES addSubtree(const byte *oid, size_t oidSize,
+				       onSubtreeCallback handler, void *arg = NULL);
+	SNMP_API_STAT_CODES addTable(const byte *oid, size_t oidSize, AgentuinoTable *table);
+	SNMP_API_STAT_CODES invalidateObject(const byte *oid, size_t oidSize);
+	// value cache of slow getters: time-to-live of an object and the counters of all objects
+	SNMP_API_STAT_CODES setObjectTtl(const byte *oid, size_t oidSize, uint32_t ms);
+	uint32_t valueCacheHits(void);
+	uint32_t valueCacheMisses(void);
+
+	// Helper functions
+	SNMP_API_STAT_CODES addVarToBindList(VAR_BIND_LIST *bindList, const char *oid, void *variable, SNMP_SYNTAXES type);
+	SNMP_API_STAT_CODES addVarToBindList(VAR_BIND_LIST *bindList, const byte *oid, uint8_t oidSize,
+					     void *variable, SNMP_SYNTAXES type);
+
+private:
+//	#ifndef DO_NOT_COMPILE_TRAPS
+	uint32_u NMS;
+	int8_t trapNum;
+	TRAP *trap_list;
+	uint8_t trapListSize;
+	char _trapCommName[SNMP_MAX_NAME_LEN + 1];
+	uint16_t _packetTrapPos;
+	uint8_t checkTrapList();
+	bool trapDue(TRAP *trap);
+	void queueTrap(int8_t trap, const uint8_t *ip, uint16_t port, bool inform);
+	SNMP_API_STAT_CODES sendNotify(const uint8_t *ip, uint16_t port,
+				       const byte *data, uint16_t size, bool inform);
+	bool ackInform(void);
+	void retryInforms(void);
+	SNMP_PDU_TYPES _notifyType = SNMP_PDU_TRAP;
+	SNMP_TRAP_TARGET _trapTargets[SNMP_MAX_TRAP_TARGETS];
+	uint8_t _trapTargetCount = 0;
+	int32_t _notifyRequestId = 0;
+	SNMP_INFORM _informs[SNMP_MAX_INFORMS] = {};
+	uint8_t _informWindow = SNMP_MAX_INFORMS;
+	uint8_t _informCount = 0;
+	uint32_t _informTimeout = SNMP_INFORM_TIMEOUT_MS;
+	uint8_t _informRetries = SNMP_INFORM_RETRIES;
+	uint32_t _informsAcked = 0;
+	uint32_t _informsFailed = 0;
+#if SNMP_TRAP_QUEUE_SIZE
+	SNMP_QUEUED_TRAP _trapQueue[SNMP_TRAP_QUEUE_SIZE] = {};
+	uint8_t _trapFirst = 0;
+	uint8_t _trapCount = 0;
+#if !defined(ARDUINO)
+	const char *_trapFile = NULL;
+	void saveTrapQueue(void);
+#endif
+#endif
+	SNMP_TRAP_OVERFLOW _trapOverflow = SNMP_TRAP_DROP_OLDEST;
+	uint32_t _trapsDropped = 0;
+//	#endif
+    	void writeHeaders(SNMP_BER_WRITER *ber, byte type, int32_t version,
+			  const char *community = NULL);
+    	SNMP_API_STAT_CODES writePacket(const uint8_t *address, uint16_t port);
+	SNMP_API_STAT_CODES buildTrapHeader(TRAP *trap);
+	SNMP_API_STAT_CODES encodeTrap(TRAP *trap, bool v2, SNMP_BER_WRITER *ber);
+	void notifyTargets(int8_t trap);
+	void clearTraps(void);
+	SNMP_API_STAT_CODES parsePdu(SNMP_PDU *pdu);
+	SNMP_API_STAT_CODES checkRequest(const SNMP_PDU_VIEW *view);
+	uint16_t varBindRoom(void);
+	void dispatchPdu(void);
+	uint16_t drain(uint16_t budget);
+	void readPacket(void);
+	bool replayResponse(void);
+	void storeResponse(void);
+	AgentuinoMib _mib;
+	AgentuinoMib *_registry;	// _mib, or the one of the agent shared with
+	uint32_t _requests = 0;
+	uint32_t _sendErrors = 0;
+	byte _packet[SNMP_MAX_PACKET_LEN];
+	uint16_t _packetSize;
+	uint16_t _packetPos;
+	bool _packetRead;	// the pending datagram is already in _packet
+	uint8_t _listenBudget = SNMP_LISTEN_BUDGET;
+#if SNMP_RESPONSE_CACHE_SIZE
+	SNMP_CACHED_RESPONSE _responses[SNMP_RESPONSE_CACHE_SIZE] = {};
+	uint8_t _responseNext = 0;
+	SNMP_REQUEST_KEY _requestKey;
+	bool _requestKeyed = false;	// _requestKey belongs to the pending request
+#endif
+	uint32_t _cacheLifetime = SNMP_RESPONSE_CACHE_MS;
+	uint32_t _cacheHits = 0;
+	uint32_t _cacheMisses = 0;
+	SNMP_PDU_TYPES _dstType;
+	uint8_t _dstIp[4];
+	uint16_t _dstPort;
+	char _getCommName[SNMP_MAX_NAME_LEN + 1];
+	char _setCommName[SNMP_MAX_NAME_LEN + 1];
+	onPduReceiveCallback _callback;
+	AgentuinoTransport *_transport;
+	bool _ownTransport;	// created by begin(), deleted with the agent
+	SNMP_API_STAT_CODES openTransport(uint16_t port);
+	// an agent owns sockets and buffers, it is never copied
+	AgentuinoClass(const AgentuinoClass &);
+	AgentuinoClass &operator=(const AgentuinoClass &);
+};
+
+extern AgentuinoClass Agentuino;
+// Create one global object
+//AgentuinoClass Agentuino;
+#endif
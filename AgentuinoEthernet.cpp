@@ -0,0 +1,64 @@
+/*
+  AgentuinoEthernet.cpp - Ethernet shield transport for the Agentuino SNMP Agent.
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#if defined(ARDUINO)
+
+#include "AgentuinoEthernet.h"
+
+SNMP_API_STAT_CODES AgentuinoEthernet::begin(uint16_t port)
+{
+	return _udp.begin(port) ? SNMP_API_STAT_SUCCESS : SNMP_API_STAT_SOCKET_ERR;
+}
+
+int AgentuinoEthernet::parsePacket(void)
+{
+	return _udp.parsePacket();
+}
+
+int AgentuinoEthernet::read(byte *buffer, size_t len)
+{
+	return _udp.read(buffer, len);
+}
+
+void AgentuinoEthernet::remote(uint8_t *ip, uint16_t *port)
+{
+	IPAddress address = _udp.remoteIP();
+
+	for ( byte i = 0; i < 4; i++ ) {
+		ip[i] = address[i];
+	}
+	*port = _udp.remotePort();
+}
+
+SNMP_API_STAT_CODES AgentuinoEthernet::send(const uint8_t *ip, uint16_t port,
+					    const byte *buffer, size_t len)
+{
+	if ( !_udp.beginPacket(IPAddress(ip[0], ip[1], ip[2], ip[3]), port) ) {
+		return SNMP_API_STAT_SOCKET_ERR;
+	}
+	_udp.write(buffer, len);
+	return _udp.endPacket() ? SNMP_API_STAT_SUCCESS : SNMP_API_STAT_SOCKET_ERR;
+}
+
+void AgentuinoEthernet::localIP(uint8_t *ip)
+{
+	IPAddress address = Ethernet.localIP();
+
+	for ( byte i = 0; i < 4; i++ ) {
+		ip[i] = address[i];
+	}
+}
+
+#endif
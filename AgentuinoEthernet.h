@@ -0,0 +1,37 @@
+/*
+  AgentuinoEthernet.h - Ethernet shield transport for the Agentuino SNMP Agent.
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef AgentuinoEthernet_h
+#define AgentuinoEthernet_h
+
+#include "Agentuino.h"
+#include <Ethernet.h>
+#include <EthernetUdp.h>
+
+class AgentuinoEthernet : public AgentuinoTransport {
+public:
+	SNMP_API_STAT_CODES begin(uint16_t port);
+	int parsePacket(void);
+	int read(byte *buffer, size_t len);
+	void remote(uint8_t *ip, uint16_t *port);
+	SNMP_API_STAT_CODES send(const uint8_t *ip, uint16_t port,
+				 const byte *buffer, size_t len);
+	void localIP(uint8_t *ip);
+
+private:
+	EthernetUDP _udp;
+};
+
+#endif
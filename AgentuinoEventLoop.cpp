@@ -0,0 +1,152 @@
+/*
+  AgentuinoEventLoop.cpp - epoll based event loop for the Agentuino SNMP Agent (Linux host build).
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#if !defined(ARDUINO) && defined(__linux__)
+
+#include "AgentuinoEventLoop.h"
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+AgentuinoEventLoop::AgentuinoEventLoop()
+{
+	_epoll = epoll_create1(EPOLL_CLOEXEC);
+	_running = false;
+	for ( uint8_t i = 0; i < SNMP_LOOP_MAX_SOURCES; i++ ) {
+		_sources[i].fd = -1;
+	}
+}
+
+AgentuinoEventLoop::~AgentuinoEventLoop()
+{
+	for ( uint8_t i = 0; i < SNMP_LOOP_MAX_SOURCES; i++ ) {
+		// timerfds belong to the loop, agent sockets to their transport
+		if ( _sources[i].fd >= 0 && _sources[i].agent == NULL ) {
+			close(_sources[i].fd);
+		}
+	}
+	if ( _epoll >= 0 ) close(_epoll);
+}
+
+// adds fd to the epoll set with its handler
+SNMP_API_STAT_CODES AgentuinoEventLoop::watch(int fd, AgentuinoClass *agent,
+					      onTimerCallback timer, void *arg)
+{
+	struct epoll_event ev;
+	SNMP_LOOP_SOURCE *source = NULL;
+
+	if ( _epoll < 0 || fd < 0 ) return SNMP_API_STAT_SOCKET_ERR;
+	for ( uint8_t i = 0; i < SNMP_LOOP_MAX_SOURCES && source == NULL; i++ ) {
+		if ( _sources[i].fd < 0 ) source = _sources + i;
+	}
+	if ( source == NULL ) return SNMP_API_STAT_MALLOC_ERR;
+	//
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.ptr = source;
+	if ( epoll_ctl(_epoll, EPOLL_CTL_ADD, fd, &ev) < 0 ) return SNMP_API_STAT_SOCKET_ERR;
+	source->fd = fd;
+	source->agent = agent;
+	source->timer = timer;
+	source->arg = arg;
+	return SNMP_API_STAT_SUCCESS;
+}
+
+/**
+ * @brief Answer the requests of an agent as soon as they arrive.
+ * @param agent - Agent whose begin() succeeded, must outlive the loop.
+ * @return - The API status code.
+ */ 
+SNMP_API_STAT_CODES AgentuinoEventLoop::add(AgentuinoClass *agent)
+{
+	return watch(agent->fd(), agent, NULL, NULL);
+}
+
+/**
+ * @brief Call a function periodically from the loop.
+ * @param intervalMs - Period in milliseconds.
+ * @param callback - Called once per wakeup, however many periods elapsed.
+ * @param arg - Passed back to callback.
+ * @return - The API status code.
+ */ 
+SNMP_API_STAT_CODES AgentuinoEventLoop::addTimer(uint32_t intervalMs, onTimerCallback callback, void *arg)
+{
+	struct itimerspec spec;
+	SNMP_API_STAT_CODES status;
+	int fd;
+
+	if ( intervalMs == 0 || callback == NULL ) return SNMP_API_STAT_PACKET_INVALID;
+	fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	if ( fd < 0 ) return SNMP_API_STAT_SOCKET_ERR;
+	spec.it_interval.tv_sec = intervalMs / 1000;
+	spec.it_interval.tv_nsec = (intervalMs % 1000) * 1000000L;
+	spec.it_value = spec.it_interval;
+	status = timerfd_settime(fd, 0, &spec, NULL) < 0 ? SNMP_API_STAT_SOCKET_ERR
+		 : watch(fd, NULL, callback, arg);
+	if ( status != SNMP_API_STAT_SUCCESS ) close(fd);
+	return status;
+}
+
+static void watchTraps(void *arg)
+{
+	((AgentuinoClass *) arg)->trapWatcher();
+}
+
+/**
+ * @brief Evaluate the trap conditions of an agent periodically.
+ * @param agent - Agent with installed traps.
+ * @param intervalMs - How often trapWatcher() runs.
+ * @return - The API status code.
+ */ 
+SNMP_API_STAT_CODES AgentuinoEventLoop::addTrapTimer(AgentuinoClass *agent, uint32_t intervalMs)
+{
+	return addTimer(intervalMs, watchTraps, agent);
+}
+
+int AgentuinoEventLoop::runOnce(int timeoutMs)
+{
+	struct epoll_event events[SNMP_LOOP_MAX_SOURCES];
+	int n;
+
+	if ( _epoll < 0 ) return -1;
+	do {
+		n = epoll_wait(_epoll, events, SNMP_LOOP_MAX_SOURCES, timeoutMs);
+	} while ( n < 0 && errno == EINTR );
+	for ( int i = 0; i < n; i++ ) {
+		SNMP_LOOP_SOURCE *source = (SNMP_LOOP_SOURCE *) events[i].data.ptr;
+
+		if ( source->agent != NULL ) {
+			source->agent->processReady();
+		} else {
+			uint64_t expirations;
+			// periods missed during a stall are dropped: a burst of calls would
+			// give trapWatcher() zero-span samples and send traps back to back
+			if ( read(source->fd, &expirations, sizeof(expirations)) != (ssize_t)sizeof(expirations) ) continue;
+			source->timer(source->arg);
+		}
+	}
+	return n;
+}
+
+void AgentuinoEventLoop::run(void)
+{
+	_running = true;
+	while ( _running ) {
+		if ( runOnce(-1) < 0 ) break;
+	}
+}
+
+#endif
@@ -0,0 +1,60 @@
+/*
+  AgentuinoEventLoop.h - epoll based event loop for the Agentuino SNMP Agent (Linux host build).
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef AgentuinoEventLoop_h
+#define AgentuinoEventLoop_h
+
+#include "Agentuino.h"
+
+// agents and timers one loop can watch
+#ifndef SNMP_LOOP_MAX_SOURCES
+#define SNMP_LOOP_MAX_SOURCES	16
+#endif
+
+typedef void (*onTimerCallback)(void *arg);
+
+typedef struct SNMP_LOOP_SOURCE {
+	int fd;			// agent socket or timerfd, -1 for a free slot
+	AgentuinoClass *agent;	// readable: agent->processReady()
+	onTimerCallback timer;	// expired: timer(arg) once, missed periods are dropped
+	void *arg;
+};
+
+//
+// Reference event loop: sleeps in epoll_wait() until a request arrives or a
+// timer expires, so an idle agent takes no CPU at all. Timers are timerfds
+// in the same epoll set; addTrapTimer() runs an agent's trapWatcher().
+class AgentuinoEventLoop {
+public:
+	AgentuinoEventLoop();
+	~AgentuinoEventLoop();
+	// watch an agent after its begin()
+	SNMP_API_STAT_CODES add(AgentuinoClass *agent);
+	SNMP_API_STAT_CODES addTimer(uint32_t intervalMs, onTimerCallback callback, void *arg = NULL);
+	SNMP_API_STAT_CODES addTrapTimer(AgentuinoClass *agent, uint32_t intervalMs);
+	// waits up to timeoutMs (-1 forever) and handles what is ready, returns the events handled
+	int runOnce(int timeoutMs = -1);
+	// runOnce() until stop()
+	void run(void);
+	void stop(void) { _running = false; }
+
+private:
+	SNMP_API_STAT_CODES watch(int fd, AgentuinoClass *agent, onTimerCallback timer, void *arg);
+	int _epoll;
+	bool _running;
+	SNMP_LOOP_SOURCE _sources[SNMP_LOOP_MAX_SOURCES];
+};
+
+#endif
@@ -0,0 +1,1262 @@
+/*
+  AgentuinoMib.cpp - MIB object registry for the Agentuino SNMP Agent.
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "Agentuino.h"
+
+/**
+ * @brief Compare two BER encoded OIDs in sub-identifier order.
+ *	  A plain memcmp is not enough: a sub-identifier that needs more
+ *	  bytes is always the bigger one, whatever its first byte is.
+ * @return - <0, 0 or >0 like memcmp.
+ */ 
+int snmpOidCompare(const byte *a, size_t aSize, const byte *b, size_t bSize)
+{
+	size_t i = 0, j = 0;
+
+	while ( i < aSize && j < bSize ) {
+		size_t ai = i, bj = j;
+		// find the end of the current sub-identifier of each side
+		while ( ai < aSize - 1 && (a[ai] & 0x80) ) ai++;
+		while ( bj < bSize - 1 && (b[bj] & 0x80) ) bj++;
+		if ( ai - i != bj - j ) {
+			return (ai - i) < (bj - j) ? -1 : 1;
+		}
+		for ( ; i <= ai; i++, j++ ) {
+			if ( a[i] != b[j] ) return a[i] < b[j] ? -1 : 1;
+		}
+	}
+	if ( i < aSize ) return 1;
+	if ( j < bSize ) return -1;
+	return 0;
+}
+
+/**
+ * @brief Encode dotted OID text ("1.3.6.1.4.1...", a leading '.' is
+ *	  accepted) as BER sub-identifiers in a single pass. Arcs may be
+ *	  anything up to 2^32-1; the first two are packed as 40 * X + Y.
+ * @param text - '\0' terminated dotted OID.
+ * @param oid - output buffer of max bytes.
+ * @param size - encoded size, 0 after an error.
+ * @return - SNMP_ERR_BAD_VALUE for malformed text or out of range arcs,
+ *	     SNMP_ERR_TOO_BIG if the encoding does not fit max bytes.
+ */
+SNMP_ERR_CODES snmpOidFromText(const char *text, byte *oid, size_t max, size_t *size)
+{
+	const char *p = text;
+	uint32_t first = 0;
+	uint8_t arcs = 0;
+	size_t pos = 0;
+
+	*size = 0;
+	if ( *p == '.' ) p++;
+	for ( ;; ) {
+		if ( *p < '0' || *p > '9' ) return SNMP_ERR_BAD_VALUE;
+		uint32_t arc = 0;
+		do {
+			uint32_t digit = *p++ - '0';
+			if ( arc > (0xFFFFFFFFUL - digit) / 10 ) return SNMP_ERR_BAD_VALUE;
+			arc = arc * 10 + digit;
+		} while ( *p >= '0' && *p <= '9' );
+		if ( *p != '.' && *p != '\0' ) return SNMP_ERR_BAD_VALUE;
+		arcs++;
+		if ( arcs == 1 ) {
+			if ( arc > 2 || *p == '\0' ) return SNMP_ERR_BAD_VALUE;
+			first = arc;
+			p++;
+			continue;
+		}
+		if ( arcs == 2 ) {
+			if ( first < 2 && arc >= 40 ) return SNMP_ERR_BAD_VALUE;
+			if ( arc > 0xFFFFFFFFUL - 40 * first ) return SNMP_ERR_BAD_VALUE;
+			arc += 40 * first;
+		}
+		// base 128, most significant group first, continuation bit on all but the last
+		uint8_t n = 1;
+		while ( n < 5 && (arc >> (7 * n)) != 0 ) n++;
+		if ( pos + n > max ) return SNMP_ERR_TOO_BIG;
+		for ( uint8_t k = n; k-- > 0; ) {
+			oid[pos++] = (byte)((arc >> (7 * k)) & 0x7F) | (k ? 0x80 : 0);
+		}
+		if ( *p == '\0' ) break;
+		p++;
+	}
+	*size = pos;
+	return SNMP_ERR_NO_ERROR;
+}
+
+/**
+ * @brief Write BER sub-identifiers as dotted text with a running cursor.
+ *	  SNMP_MAX_OID_TEXT_LEN bytes are always enough for a SNMP_OID.
+ * @param oid - BER encoded OID, without tag and length.
+ * @param text - output buffer of max bytes, '\0' terminated on success.
+ * @return - SNMP_ERR_BAD_VALUE for an empty or malformed encoding,
+ *	     SNMP_ERR_TOO_BIG if the text does not fit max bytes.
+ */
+SNMP_ERR_CODES snmpOidToText(const byte *oid, size_t size, char *text, size_t max)
+{
+	char *out = text;
+	char *end = text + max;
+	size_t i = 0;
+
+	if ( size == 0 ) return SNMP_ERR_BAD_VALUE;
+	while ( i < size ) {
+		uint32_t subid = 0;
+		uint8_t n = 0;
+		byte b;
+		do {
+			// more than 32 bits or a sub-identifier cut short
+			if ( n == 5 || i == size ) return SNMP_ERR_BAD_VALUE;
+			b = oid[i++];
+			if ( n == 4 && (subid >> 25) != 0 ) return SNMP_ERR_BAD_VALUE;
+			subid = (subid << 7) | (b & 0x7F);
+			n++;
+		} while ( b & 0x80 );
+		if ( out != text ) {
+			if ( out == end ) return SNMP_ERR_TOO_BIG;
+			*out++ = '.';
+		} else {
+			// the first sub-identifier holds the first two arcs
+			uint8_t x = subid < 80 ? subid / 40 : 2;
+			if ( end - out < 2 ) return SNMP_ERR_TOO_BIG;
+			*out++ = '0' + x;
+			*out++ = '.';
+			subid -= 40 * x;
+		}
+		char digits[10];
+		uint8_t d = 0;
+		do {
+			digits[d++] = '0' + subid % 10;
+			subid /= 10;
+		} while ( subid );
+		if ( (size_t)(end - out) < d ) return SNMP_ERR_TOO_BIG;
+		while ( d ) *out++ = digits[--d];
+	}
+	if ( out == end ) return SNMP_ERR_TOO_BIG;
+	*out = '\0';
+	return SNMP_ERR_NO_ERROR;
+}
+
+// index of the first entry (SNMP_OBJECT or SNMP_SUBTREE) not ordered before oid
+template <typename T>
+static uint16_t lowerBound(const T *items, uint16_t count, const byte *oid, size_t size)
+{
+	uint16_t lo = 0, hi = count;
+
+	while ( lo < hi ) {
+		uint16_t mid = (lo + hi) / 2;
+		if ( snmpOidCompare(items[mid].oid, items[mid].oidSize, oid, size) < 0 ) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+// sorted insert, an entry with the same OID is replaced
+template <typename T>
+static SNMP_API_STAT_CODES insertSorted(T **items, uint16_t *count, uint16_t *capacity, const T *item)
+{
+	if ( item->oidSize > SNMP_MAX_OID_LEN ) {
+		return SNMP_API_STAT_OID_TOO_BIG;
+	}
+	uint16_t pos = lowerBound(*items, *count, item->oid, item->oidSize);
+	//
+	if ( pos < *count && snmpOidCompare((*items)[pos].oid, (*items)[pos].oidSize,
+					    item->oid, item->oidSize) == 0 ) {
+		(*items)[pos] = *item;
+		return SNMP_API_STAT_SUCCESS;
+	}
+	//
+	// grow the table (entries are normally added once from setup())
+	if ( *count == *capacity ) {
+		uint16_t grown = *capacity ? *capacity * 2 : 8;
+		T *table = (T *) realloc(*items, sizeof(T) * grown);
+		if ( table == NULL ) {
+			return SNMP_API_STAT_MALLOC_ERR;
+		}
+		*items = table;
+		*capacity = grown;
+	}
+	memmove(*items + pos + 1, *items + pos, sizeof(T) * (*count - pos));
+	(*items)[pos] = *item;
+	(*count)++;
+	return SNMP_API_STAT_SUCCESS;
+}
+
+// splits the sub-identifiers of a BER encoded OID suffix
+static bool decodeInstance(const byte *data, size_t size, SNMP_INSTANCE *instance)
+{
+	uint32_t arc = 0;
+
+	instance->size = 0;
+	for ( size_t i = 0; i < size; i++ ) {
+		arc = (arc << 7) | (data[i] & 0x7F);
+		if ( !(data[i] & 0x80) ) {
+			if ( instance->size == SNMP_MAX_INSTANCE_ARCS ) return false;
+			instance->arcs[instance->size++] = arc;
+			arc = 0;
+		}
+	}
+	return size == 0 || !(data[size - 1] & 0x80);
+}
+
+// BER encodes count sub-identifiers into data, the size or 0 if they do not fit max bytes
+static size_t encodeArcs(const uint32_t *arcs, uint8_t count, byte *data, size_t max)
+{
+	size_t pos = 0;
+
+	for ( uint8_t i = 0; i < count; i++ ) {
+		uint32_t arc = arcs[i];
+		byte n = 1;
+		while ( n < 5 && (arc >> (7 * n)) ) n++;
+		if ( pos + n > max ) return 0;
+		while ( n-- ) {
+			data[pos++] = ((arc >> (7 * n)) & 0x7F) | (n ? 0x80 : 0);
+		}
+	}
+	return pos;
+}
+
+// oid = prefix + instance, false if it does not fit SNMP_MAX_OID_LEN
+static bool buildInstanceOid(SNMP_OID *oid, const byte *prefix, size_t prefixSize,
+			     const SNMP_INSTANCE *instance)
+{
+	size_t size;
+
+	if ( prefixSize > SNMP_MAX_OID_LEN ) return false;
+	memcpy(oid->data, prefix, prefixSize);
+	size = encodeArcs(instance->arcs, instance->size, oid->data + prefixSize,
+			  SNMP_MAX_OID_LEN - prefixSize);
+	if ( size == 0 && instance->size ) return false;
+	oid->size = prefixSize + size;
+	return true;
+}
+
+// the value cache is shared by worker threads on the host, Arduino has only one
+static void lockCache(SNMP_VALUE_CACHE *cache)
+{
+#if !defined(ARDUINO)
+	pthread_mutex_lock(&cache->lock);
+#endif
+}
+
+static void unlockCache(SNMP_VALUE_CACHE *cache)
+{
+#if !defined(ARDUINO)
+	pthread_mutex_unlock(&cache->lock);
+#endif
+}
+
+static void freeCache(SNMP_OBJECT *object)
+{
+	if ( object->cache == NULL ) return;
+#if !defined(ARDUINO)
+	pthread_mutex_destroy(&object->cache->lock);
+#endif
+	SNMP_FREE(object->cache);
+}
+
+AgentuinoMib::AgentuinoMib()
+{
+	_objects = NULL;
+	_count = 0;
+	_capacity = 0;
+	_subtrees = NULL;
+	_subtreeCount = 0;
+	_subtreeCapacity = 0;
+	_frozen = false;
+}
+
+AgentuinoMib::~AgentuinoMib()
+{
+	for ( uint16_t i = 0; i < _count; i++ ) {
+		SNMP_FREE(_objects[i].encoded);
+		freeCache(_objects + i);
+	}
+	SNMP_FREE(_objects);
+	SNMP_FREE(_subtrees);
+}
+
+/**
+ * @brief Register an object. Registering an OID again replaces the old entry.
+ * @param object - Object description, copied into the registry.
+ * @return - The API status code.
+ */ 
+SNMP_API_STAT_CODES AgentuinoMib::add(const SNMP_OBJECT *object)
+{
+	SNMP_OBJECT entry = *object;
+	SNMP_OBJECT *old;
+
+	if ( _frozen ) {
+		return SNMP_API_STAT_MIB_FROZEN;
+	}
+	old = find(object->oid, object->oidSize);
+	if ( old != NULL ) {
+		SNMP_FREE(old->encoded);
+		freeCache(old);
+	}
+	entry.encoded = NULL;
+	entry.encodedSize = 0;
+	entry.cache = NULL;
+	return insertSorted(&_objects, &_count, &_capacity, &entry);
+}
+
+/**
+ * @brief Register a subtree handler. Registering a prefix again replaces the old entry.
+ * @param subtree - Subtree description, copied into the registry.
+ * @return - The API status code.
+ */ 
+SNMP_API_STAT_CODES AgentuinoMib::addSubtree(const SNMP_SUBTREE *subtree)
+{
+	if ( _frozen ) {
+		return SNMP_API_STAT_MIB_FROZEN;
+	}
+	return insertSorted(&_subtrees, &_subtreeCount, &_subtreeCapacity, subtree);
+}
+
+/**
+ * @brief Forget the cached binding of a SNMP_ACCESS_STATIC object, the next
+ *	  request encodes the current value again.
+ * @return - SNMP_API_STAT_NO_SUCH_NAME if no object is registered at oid.
+ */ 
+SNMP_API_STAT_CODES AgentuinoMib::invalidate(const byte *oid, size_t size)
+{
+	SNMP_OBJECT *object = find(oid, size);
+
+	if ( _frozen ) {
+		return SNMP_API_STAT_MIB_FROZEN;
+	}
+	if ( object == NULL ) {
+		return SNMP_API_STAT_NO_SUCH_NAME;
+	}
+	SNMP_FREE(object->encoded);
+	object->encodedSize = 0;
+	if ( object->cache != NULL ) {
+		object->cache->valid = false;
+	}
+	return SNMP_API_STAT_SUCCESS;
+}
+
+/**
+ * @brief Serve an object from a value cache. A read is reused for ttl
+ *	  time_ticks, so a walk or several managers polling a slow getter
+ *	  (I2C sensor, ADC average, ...) call it once per period. Requests
+ *	  meeting a stale value while it is read again wait for that read
+ *	  instead of starting their own. A SET through the registry and
+ *	  invalidate() drop the cached value.
+ * @param ttl - Time-to-live in time_ticks (10 ms), 0 removes the cache.
+ * @return - SNMP_API_STAT_NO_SUCH_NAME if no object is registered at oid,
+ *	     SNMP_API_STAT_MALLOC_ERR.
+ */ 
+SNMP_API_STAT_CODES AgentuinoMib::setTtl(const byte *oid, size_t size, uint32_t ttl)
+{
+	SNMP_OBJECT *object = find(oid, size);
+
+	if ( _frozen ) {
+		return SNMP_API_STAT_MIB_FROZEN;
+	}
+	if ( object == NULL ) {
+		return SNMP_API_STAT_NO_SUCH_NAME;
+	}
+	if ( ttl == 0 ) {
+		freeCache(object);
+		return SNMP_API_STAT_SUCCESS;
+	}
+	if ( object->cache == NULL ) {
+		object->cache = (SNMP_VALUE_CACHE *) calloc(1, sizeof(SNMP_VALUE_CACHE));
+		if ( object->cache == NULL ) {
+			return SNMP_API_STAT_MALLOC_ERR;
+		}
+#if !defined(ARDUINO)
+		pthread_mutex_init(&object->cache->lock, NULL);
+#endif
+	}
+	object->cache->ttl = ttl;
+	object->cache->valid = false;
+	return SNMP_API_STAT_SUCCESS;
+}
+
+SNMP_API_STAT_CODES AgentuinoMib::valueCacheStats(const byte *oid, size_t size,
+						  uint32_t *hits, uint32_t *misses)
+{
+	uint16_t first = 0, last = _count;
+
+	*hits = 0;
+	*misses = 0;
+	if ( oid != NULL ) {
+		SNMP_OBJECT *object = find(oid, size);
+		if ( object == NULL ) {
+			return SNMP_API_STAT_NO_SUCH_NAME;
+		}
+		first = object - _objects;
+		last = first + 1;
+	}
+	for ( uint16_t i = first; i < last; i++ ) {
+		SNMP_VALUE_CACHE *cache = _objects[i].cache;
+		if ( cache == NULL ) continue;
+		lockCache(cache);
+		*hits += cache->hits;
+		*misses += cache->misses;
+		unlockCache(cache);
+	}
+	return SNMP_API_STAT_SUCCESS;
+}
+
+/**
+ * @brief Make the registry immutable. The bindings of every static object
+ *	  are encoded now; afterwards requests only read the registry, so
+ *	  agents on several threads can share it. add(), addSubtree() and
+ *	  invalidate() fail from then on. Get/set callbacks and subtree
+ *	  handlers may still run concurrently and must be thread-safe.
+ * @param void
+ * @return void
+ */ 
+void AgentuinoMib::freeze(void)
+{
+	SNMP_VARBIND vb;
+
+	for ( uint16_t i = 0; i < _count; i++ ) {
+		SNMP_OBJECT *object = _objects + i;
+
+		if ( object->access != SNMP_ACCESS_STATIC || object->cache != NULL ) continue;
+		memcpy(vb.OID.data, object->oid, object->oidSize);
+		vb.OID.size = object->oidSize;
+		objectBinding(object, &vb, 0);
+	}
+	_frozen = true;
+}
+
+/**
+ * @brief Exact match lookup.
+ * @return - The object or NULL.
+ */ 
+SNMP_OBJECT *AgentuinoMib::find(const byte *oid, size_t size)
+{
+	uint16_t pos = lowerBound(_objects, _count, oid, size);
+
+	if ( pos < _count && snmpOidCompare(_objects[pos].oid, _objects[pos].oidSize, oid, size) == 0 ) {
+		return _objects + pos;
+	}
+	return NULL;
+}
+
+/**
+ * @brief Lexicographic successor lookup (GET-NEXT).
+ * @return - The first object ordered after oid, or NULL at the end of the MIB.
+ */ 
+SNMP_OBJECT *AgentuinoMib::next(const byte *oid, size_t size)
+{
+	uint16_t pos = lowerBound(_objects, _count, oid, size);
+
+	if ( pos < _count && snmpOidCompare(_objects[pos].oid, _objects[pos].oidSize, oid, size) == 0 ) {
+		pos++;
+	}
+	return pos < _count ? _objects + pos : NULL;
+}
+
+/**
+ * @brief Longest-prefix match of oid against the registered subtrees.
+ *	  Every sub-identifier boundary of oid is looked up once, so the cost
+ *	  grows with the depth of oid and not with the number of instances.
+ * @return - The innermost subtree containing oid, or NULL.
+ */ 
+SNMP_SUBTREE *AgentuinoMib::findSubtree(const byte *oid, size_t size)
+{
+	SNMP_SUBTREE *found = NULL;
+
+	if ( _subtreeCount == 0 ) return NULL;
+	for ( size_t end = 1; end <= size; end++ ) {
+		if ( oid[end - 1] & 0x80 ) continue;	// inside a sub-identifier
+		uint16_t pos = lowerBound(_subtrees, _subtreeCount, oid, end);
+		if ( pos == _subtreeCount ) break;	// no prefix can match any more
+		if ( _subtrees[pos].oidSize == end && memcmp(_subtrees[pos].oid, oid, end) == 0 ) {
+			found = _subtrees + pos;
+		}
+	}
+	return found;
+}
+
+SNMP_ERR_CODES AgentuinoMib::getValue(SNMP_OBJECT *object, SNMP_VALUE *value)
+{
+	if ( object->get != NULL ) {
+		return object->get(value);
+	}
+	if ( object->var == NULL ) {
+		return SNMP_ERR_GEN_ERROR;
+	}
+	switch ( object->syntax ) {
+		case SNMP_SYNTAX_OCTETS:
+		case SNMP_SYNTAX_OPAQUE:
+			return value->encode(object->syntax, (const char *) object->var);
+		case SNMP_SYNTAX_INT:
+			return value->encode(object->syntax, *(int32_t *) object->var);
+		case SNMP_SYNTAX_COUNTER:
+		case SNMP_SYNTAX_GAUGE:
+		case SNMP_SYNTAX_TIME_TICKS:
+		case SNMP_SYNTAX_UINT32:
+			return value->encode(object->syntax, *(uint32_t *) object->var);
+		case SNMP_SYNTAX_COUNTER64:
+			return value->encode(object->syntax, *(uint64_t *) object->var);
+		case SNMP_SYNTAX_IP_ADDRESS:
+		case SNMP_SYNTAX_NSAPADDR:
+			return value->encode(object->syntax, (const byte *) object->var);
+		case SNMP_SYNTAX_BOOL:
+			return value->encode(object->syntax, *(bool *) object->var);
+		case SNMP_SYNTAX_OID: {
+			SNMP_OID *oid = (SNMP_OID *) object->var;
+			memcpy(value->data, oid->data, oid->size);
+			value->size = oid->size;
+			value->syntax = SNMP_SYNTAX_OID;
+			return SNMP_ERR_NO_ERROR;
+		}
+		default:
+			return SNMP_ERR_GEN_ERROR;
+	}
+}
+
+// access, syntax and size checks of a SET on a registered object
+SNMP_ERR_CODES AgentuinoMib::checkValue(SNMP_OBJECT *object, SNMP_VALUE *value)
+{
+	if ( object->access != SNMP_ACCESS_READ_WRITE
+		|| (object->set == NULL && object->var == NULL) ) {
+		return SNMP_ERR_READ_ONLY;
+	}
+	if ( value->syntax != object->syntax ) {
+		return SNMP_ERR_WRONG_TYPE;
+	}
+	if ( object->set != NULL ) {
+		return SNMP_ERR_NO_ERROR;
+	}
+	switch ( object->syntax ) {
+		case SNMP_SYNTAX_OCTETS:
+		case SNMP_SYNTAX_OPAQUE:
+			// keep room for the terminating '\0'
+			return value->size < object->varSize ? SNMP_ERR_NO_ERROR : SNMP_ERR_WRONG_LENGTH;
+		case SNMP_SYNTAX_IP_ADDRESS:
+		case SNMP_SYNTAX_NSAPADDR:
+			return value->size == 4 ? SNMP_ERR_NO_ERROR : SNMP_ERR_WRONG_LENGTH;
+		case SNMP_SYNTAX_INT:
+		case SNMP_SYNTAX_COUNTER:
+		case SNMP_SYNTAX_GAUGE:
+		case SNMP_SYNTAX_TIME_TICKS:
+		case SNMP_SYNTAX_UINT32:
+		case SNMP_SYNTAX_COUNTER64:
+		case SNMP_SYNTAX_BOOL:
+			return SNMP_ERR_NO_ERROR;
+		default:
+			return SNMP_ERR_WRONG_TYPE;
+	}
+}
+
+SNMP_ERR_CODES AgentuinoMib::setValue(SNMP_OBJECT *object, SNMP_VALUE *value)
+{
+	SNMP_ERR_CODES error = checkValue(object, value);
+
+	if ( error != SNMP_ERR_NO_ERROR ) {
+		return error;
+	}
+	if ( object->set != NULL ) {
+		return object->set(value);
+	}
+	switch ( object->syntax ) {
+		case SNMP_SYNTAX_OCTETS:
+		case SNMP_SYNTAX_OPAQUE:
+			memcpy(object->var, value->data, value->size);
+			((char *) object->var)[value->size] = '\0';
+			return SNMP_ERR_NO_ERROR;
+		case SNMP_SYNTAX_INT:
+			return value->decode((int32_t *) object->var);
+		case SNMP_SYNTAX_BOOL:
+			return value->decode((bool *) object->var);
+		case SNMP_SYNTAX_IP_ADDRESS:
+		case SNMP_SYNTAX_NSAPADDR:
+			return value->decode((byte *) object->var);
+		case SNMP_SYNTAX_COUNTER64:
+			return value->decode((uint64_t *) object->var);
+		default:
+			return value->decode((uint32_t *) object->var);
+	}
+}
+
+// getValue() through the value cache of object, now is the time_ticks of the request
+SNMP_ERR_CODES AgentuinoMib::cachedValue(SNMP_OBJECT *object, SNMP_VALUE *value, uint32_t now)
+{
+	SNMP_VALUE_CACHE *cache = object->cache;
+	SNMP_ERR_CODES error = SNMP_ERR_NO_ERROR;
+
+	if ( cache == NULL ) {
+		return getValue(object, value);
+	}
+	// held during the read: concurrent requests wait for it and then hit
+	lockCache(cache);
+	// signed, a worker whose clock is a little behind the read still hits
+	if ( cache->valid && (int32_t) (now - cache->ticks) < (int32_t) cache->ttl ) {
+		cache->hits++;
+		memcpy(value->data, cache->value.data, cache->value.size);
+		value->size = cache->value.size;
+		value->syntax = cache->value.syntax;
+	} else {
+		cache->misses++;
+		error = getValue(object, value);
+		if ( error == SNMP_ERR_NO_ERROR ) {
+			cache->value = *value;
+			cache->ticks = now;
+			cache->valid = true;
+		}
+	}
+	unlockCache(cache);
+	return error;
+}
+
+/**
+ * @brief Fill a response binding from a registered object. The binding of a
+ *	  SNMP_ACCESS_STATIC object is encoded once and then only referenced,
+ *	  responsePdu() copies it as a whole. Objects with a time-to-live
+ *	  answer from their value cache instead.
+ * @param object - Object at vb->OID.
+ * @param vb - Binding to answer, VALUE is left empty when the cache is used.
+ * @param now - time_ticks of the request.
+ * @return - The SNMP error code of getValue().
+ */ 
+SNMP_ERR_CODES AgentuinoMib::objectBinding(SNMP_OBJECT *object, SNMP_VARBIND *vb, uint32_t now)
+{
+	SNMP_ERR_CODES error;
+	SNMP_BER_WRITER ber;
+	uint16_t size;
+
+	vb->cached = NULL;
+	if ( object->cache != NULL ) {
+		return cachedValue(object, &vb->VALUE, now);
+	}
+	if ( object->encoded == NULL ) {
+		error = getValue(object, &vb->VALUE);
+		if ( error != SNMP_ERR_NO_ERROR || object->access != SNMP_ACCESS_STATIC || _frozen ) {
+			return error;
+		}
+		size = vb->encodedSize();
+		object->encoded = (byte *) malloc(size);
+		if ( object->encoded == NULL ) {
+			return SNMP_ERR_NO_ERROR;	// answered uncached
+		}
+		ber.begin(object->encoded, size);
+		vb->encode(&ber);
+		object->encodedSize = size;
+	}
+	vb->cached = object->encoded;
+	vb->cachedSize = object->encodedSize;
+	vb->VALUE.syntax = object->syntax;
+	vb->VALUE.size = 0;
+	return SNMP_ERR_NO_ERROR;
+}
+
+// GET of one binding, registered objects may answer from their cache
+SNMP_ERR_CODES AgentuinoMib::getBinding(SNMP_PDU *pdu, SNMP_VARBIND *vb)
+{
+	SNMP_OBJECT *object = find(vb->OID.data, vb->OID.size);
+
+	vb->cached = NULL;
+	if ( object != NULL ) {
+		return objectBinding(object, vb, pdu->time_ticks);
+	}
+	return subtreeGet(&vb->OID, &vb->VALUE);
+}
+
+SNMP_ERR_CODES AgentuinoMib::get(SNMP_OID *oid, SNMP_VALUE *value)
+{
+	SNMP_OBJECT *object = find(oid->data, oid->size);
+
+	if ( object != NULL ) {
+		return cachedValue(object, value, millis() / 10);
+	}
+	return subtreeGet(oid, value);
+}
+
+// GET of an OID that is not a registered object
+SNMP_ERR_CODES AgentuinoMib::subtreeGet(SNMP_OID *oid, SNMP_VALUE *value)
+{
+	SNMP_SUBTREE *subtree = findSubtree(oid->data, oid->size);
+	SNMP_INSTANCE instance;
+
+	if ( subtree == NULL || !decodeInstance(oid->data + subtree->oidSize,
+						oid->size - subtree->oidSize, &instance) ) {
+		return SNMP_ERR_NO_SUCH_NAME;
+	}
+	return subtree->handler(SNMP_PDU_GET, &instance, value, subtree->arg);
+}
+
+SNMP_ERR_CODES AgentuinoMib::set(SNMP_OID *oid, SNMP_VALUE *value)
+{
+	SNMP_OBJECT *object = find(oid->data, oid->size);
+	SNMP_SUBTREE *subtree;
+	SNMP_INSTANCE instance;
+
+	if ( object != NULL ) {
+		SNMP_ERR_CODES error = setValue(object, value);
+		if ( error == SNMP_ERR_NO_ERROR && object->cache != NULL ) {
+			lockCache(object->cache);
+			object->cache->valid = false;
+			unlockCache(object->cache);
+		}
+		return error;
+	}
+	subtree = findSubtree(oid->data, oid->size);
+	if ( subtree == NULL || !decodeInstance(oid->data + subtree->oidSize,
+						oid->size - subtree->oidSize, &instance) ) {
+		return SNMP_ERR_NO_SUCH_NAME;
+	}
+	return subtree->handler(SNMP_PDU_SET, &instance, value, subtree->arg);
+}
+
+SNMP_ERR_CODES AgentuinoMib::testSet(SNMP_OID *oid, SNMP_VALUE *value)
+{
+	SNMP_OBJECT *object = find(oid->data, oid->size);
+
+	SNMP_SUBTREE *subtree;
+	SNMP_INSTANCE instance;
+	SNMP_VALUE copy;
+
+	if ( object != NULL ) {
+		return checkValue(object, value);
+	}
+	subtree = findSubtree(oid->data, oid->size);
+	if ( subtree == NULL || !decodeInstance(oid->data + subtree->oidSize,
+						oid->size - subtree->oidSize, &instance) ) {
+		return SNMP_ERR_NO_SUCH_NAME;
+	}
+	// a handler unaware of the test may answer it like a GET, the SET keeps its value
+	copy = *value;
+	return subtree->handler(SNMP_PDU_TEST_SET, &instance, &copy, subtree->arg);
+}
+
+// asks a subtree handler for the instance following instance, oid gets the full OID
+SNMP_ERR_CODES AgentuinoMib::subtreeNext(SNMP_SUBTREE *subtree, SNMP_INSTANCE *instance,
+					 SNMP_OID *oid, SNMP_VALUE *value)
+{
+	SNMP_ERR_CODES error = subtree->handler(SNMP_PDU_GET_NEXT, instance, value, subtree->arg);
+
+	if ( error != SNMP_ERR_NO_ERROR ) {
+		return error;
+	}
+	if ( !buildInstanceOid(oid, subtree->oid, subtree->oidSize, instance) ) {
+		return SNMP_ERR_TOO_BIG;
+	}
+	return SNMP_ERR_NO_ERROR;
+}
+
+SNMP_ERR_CODES AgentuinoMib::getNext(SNMP_OID *oid, SNMP_VALUE *value)
+{
+	SNMP_OBJECT *object;
+	SNMP_ERR_CODES error = nextEntry(oid, value, &object);
+
+	if ( error == SNMP_ERR_NO_ERROR && object != NULL ) {
+		return cachedValue(object, value, millis() / 10);
+	}
+	return error;
+}
+
+/**
+ * @brief GET-NEXT over registered objects and subtrees.
+ *	  The successor is the smallest of: the next scalar object, the next
+ *	  instance of every subtree containing oid, and the first instance of
+ *	  the subtrees registered after oid.
+ * @param oid - Request OID, replaced by the successor on success.
+ * @param value - Receives the value of a subtree successor.
+ * @param object - The successor if it is a registered object, whose value
+ *		   is left to the caller, else NULL.
+ * @return - SNMP_ERR_NO_SUCH_NAME at the end of the MIB.
+ */ 
+SNMP_ERR_CODES AgentuinoMib::nextEntry(SNMP_OID *oid, SNMP_VALUE *value, SNMP_OBJECT **object)
+{
+	SNMP_OBJECT *scalar = next(oid->data, oid->size);
+	SNMP_OID best, candidate;
+	SNMP_VALUE tmp;
+	SNMP_INSTANCE instance;
+	bool found = false;
+
+	if ( _subtreeCount ) {
+		// subtrees containing oid: continue inside each of them
+		for ( size_t end = 1; end <= oid->size; end++ ) {
+			if ( oid->data[end - 1] & 0x80 ) continue;
+			uint16_t pos = lowerBound(_subtrees, _subtreeCount, oid->data, end);
+			if ( pos == _subtreeCount ) break;
+			SNMP_SUBTREE *subtree = _subtrees + pos;
+			if ( subtree->oidSize != end || memcmp(subtree->oid, oid->data, end) != 0 ) continue;
+			if ( !decodeInstance(oid->data + end, oid->size - end, &instance) ) continue;
+			if ( subtreeNext(subtree, &instance, &candidate, &tmp) != SNMP_ERR_NO_ERROR ) continue;
+			if ( !found || snmpOidCompare(candidate.data, candidate.size, best.data, best.size) < 0 ) {
+				best = candidate;
+				*value = tmp;
+				found = true;
+			}
+		}
+		//
+		// subtrees registered after oid: first instance of the first non-empty one
+		uint16_t pos = lowerBound(_subtrees, _subtreeCount, oid->data, oid->size);
+		for ( ; pos < _subtreeCount; pos++ ) {
+			SNMP_SUBTREE *subtree = _subtrees + pos;
+			if ( found && snmpOidCompare(subtree->oid, subtree->oidSize, best.data, best.size) >= 0 ) break;
+			if ( subtree->oidSize == oid->size && memcmp(subtree->oid, oid->data, oid->size) == 0 ) continue;
+			instance.size = 0;
+			if ( subtreeNext(subtree, &instance, &candidate, &tmp) != SNMP_ERR_NO_ERROR ) continue;
+			if ( !found || snmpOidCompare(candidate.data, candidate.size, best.data, best.size) < 0 ) {
+				best = candidate;
+				*value = tmp;
+				found = true;
+			}
+		}
+	}
+	//
+	*object = NULL;
+	if ( scalar != NULL && (!found
+		|| snmpOidCompare(scalar->oid, scalar->oidSize, best.data, best.size) < 0) ) {
+		memcpy(oid->data, scalar->oid, scalar->oidSize);
+		oid->size = scalar->oidSize;
+		*object = scalar;
+		return SNMP_ERR_NO_ERROR;
+	}
+	if ( !found ) {
+		return SNMP_ERR_NO_SUCH_NAME;
+	}
+	*oid = best;
+	return SNMP_ERR_NO_ERROR;
+}
+
+// SNMPv1 has no equivalent of the newer error codes (RFC 2576, 4.3)
+static SNMP_ERR_CODES v1Error(SNMP_ERR_CODES error)
+{
+	switch ( error ) {
+		case SNMP_ERR_WRONG_VALUE:
+		case SNMP_ERR_WRONG_ENCODING:
+		case SNMP_ERR_WRONG_TYPE:
+		case SNMP_ERR_WRONG_LENGTH:
+		case SNMP_ERR_INCONSISTANT_VALUE:
+			return SNMP_ERR_BAD_VALUE;
+		case SNMP_ERR_NO_ACCESS:
+		case SNMP_ERR_NOT_WRITABLE:
+		case SNMP_ERR_NO_CREATION:
+		case SNMP_ERR_INCONSISTEN_NAME:
+		case SNMP_ERR_AUTHORIZATION_ERROR:
+			return SNMP_ERR_NO_SUCH_NAME;
+		case SNMP_ERR_RESOURCE_UNAVAILABLE:
+		case SNMP_ERR_COMMIT_FAILED:
+		case SNMP_ERR_UNDO_FAILED:
+			return SNMP_ERR_GEN_ERROR;
+		default:
+			return error;
+	}
+}
+
+// and the SNMPv2c error for the SNMPv1 style codes used by the registry
+static SNMP_ERR_CODES v2Error(SNMP_ERR_CODES error)
+{
+	switch ( error ) {
+		case SNMP_ERR_READ_ONLY:
+			return SNMP_ERR_NOT_WRITABLE;
+		case SNMP_ERR_BAD_VALUE:
+			return SNMP_ERR_WRONG_VALUE;
+		case SNMP_ERR_NO_SUCH_NAME:
+			return SNMP_ERR_NO_CREATION;
+		default:
+			return error;
+	}
+}
+
+// sets an SNMPv2 exception in place of the value
+static void setException(SNMP_VALUE *value, SNMP_SYNTAXES exception)
+{
+	value->syntax = exception;
+	value->size = 0;
+}
+
+// GET-NEXT of one binding; SNMPv2c reports the end of the MIB as endOfMibView
+SNMP_ERR_CODES AgentuinoMib::getNextBinding(SNMP_PDU *pdu, SNMP_VARBIND *vb)
+{
+	SNMP_OBJECT *object;
+	SNMP_ERR_CODES error;
+
+	vb->cached = NULL;
+	if ( vb->VALUE.syntax == SNMP_SYNTAX_END_OF_MIB_VIEW ) {
+		return SNMP_ERR_NO_ERROR;
+	}
+	error = nextEntry(&vb->OID, &vb->VALUE, &object);
+	if ( error == SNMP_ERR_NO_ERROR && object != NULL ) {
+		return objectBinding(object, vb, pdu->time_ticks);
+	}
+	if ( error == SNMP_ERR_NO_SUCH_NAME && pdu->version != SNMP_VERSION_1 ) {
+		setException(&vb->VALUE, SNMP_SYNTAX_END_OF_MIB_VIEW);
+		return SNMP_ERR_NO_ERROR;
+	}
+	return error;
+}
+
+/**
+ * @brief Answer a GET-BULK request. The first non-repeaters bindings get one
+ *	  successor each, the remaining ones up to max-repetitions successors.
+ *	  Results are produced in place and stop as soon as the next binding
+ *	  would not fit into room bytes or SNMP_MAX_VARBINDS, or when every
+ *	  repeater reached the end of the MIB.
+ */ 
+void AgentuinoMib::processBulk(SNMP_PDU *pdu, uint16_t room)
+{
+	int32_t nonRepeaters = pdu->nonRepeaters;
+	int32_t maxRepetitions = pdu->maxRepetitions;
+	uint8_t count = pdu->varBindCount;
+	uint8_t repeaters, out = 0;
+	uint16_t used = 0;
+	bool truncated = false, ended = true;
+	SNMP_ERR_CODES error = SNMP_ERR_NO_ERROR;
+
+	if ( nonRepeaters < 0 ) nonRepeaters = 0;
+	if ( nonRepeaters > count ) nonRepeaters = count;
+	if ( maxRepetitions < 0 ) maxRepetitions = 0;
+	repeaters = count - nonRepeaters;
+	if ( maxRepetitions == 0 ) count = nonRepeaters;
+	//
+	// non-repeaters and the first repetition answer the request bindings in place
+	for ( ; out < count && !truncated; out++ ) {
+		error = getNextBinding(pdu, pdu->varBinds + out);
+		if ( error != SNMP_ERR_NO_ERROR ) break;
+		used += pdu->varBinds[out].encodedSize();
+		truncated = (used > room);
+	}
+	if ( truncated ) out--;
+	// once every repeater is at the end of the MIB, further repetitions repeat it
+	for ( uint8_t j = nonRepeaters; j < out; j++ ) {
+		if ( pdu->varBinds[j].VALUE.syntax != SNMP_SYNTAX_END_OF_MIB_VIEW ) ended = false;
+	}
+	//
+	// every further repetition continues from the one before it
+	for ( int32_t r = 1; r < maxRepetitions && !ended && !truncated && error == SNMP_ERR_NO_ERROR; r++ ) {
+		ended = true;
+		for ( uint8_t j = 0; j < repeaters; j++ ) {
+			if ( out == SNMP_MAX_VARBINDS ) {
+				truncated = true;
+				break;
+			}
+			SNMP_VARBIND *vb = pdu->varBinds + out;
+			*vb = pdu->varBinds[out - repeaters];
+			error = getNextBinding(pdu, vb);
+			if ( error != SNMP_ERR_NO_ERROR ) break;
+			used += vb->encodedSize();
+			if ( used > room ) {
+				truncated = true;
+				break;
+			}
+			if ( vb->VALUE.syntax != SNMP_SYNTAX_END_OF_MIB_VIEW ) ended = false;
+			out++;
+		}
+	}
+	//
+	pdu->type = SNMP_PDU_RESPONSE;
+	pdu->error = error;
+	pdu->errorIndex = (error == SNMP_ERR_NO_ERROR) ? 0 : out + 1;
+	pdu->varBindCount = out;
+}
+
+/**
+ * @brief Answer a GET, GET-NEXT, SET or GET-BULK request from the registry
+ *	  and turn the pdu into the matching response. Processing stops at the
+ *	  first failing variable binding, whose 1-based position becomes the
+ *	  error index. Every binding of a SET is checked, subtree handlers
+ *	  with a SNMP_PDU_TEST_SET call, before any value is applied.
+ *	  SNMPv2c requests report missing objects and the end of the MIB as
+ *	  exceptions in the binding instead of an error.
+ * @param pdu - Request decoded by AgentuinoClass::requestPdu().
+ * @param room - Bytes available for the response bindings (GET-BULK).
+ * @return void
+ */ 
+void AgentuinoMib::process(SNMP_PDU *pdu, uint16_t room)
+{
+	SNMP_ERR_CODES error = SNMP_ERR_NO_ERROR;
+	bool v1 = (pdu->version == SNMP_VERSION_1);
+	uint8_t i;
+
+	if ( pdu->type == SNMP_PDU_GET_BULK ) {
+		processBulk(pdu, room);
+		return;
+	}
+	if ( pdu->type == SNMP_PDU_SET ) {
+		for ( i = 0; i < pdu->varBindCount; i++ ) {
+			error = testSet(&pdu->varBinds[i].OID, &pdu->varBinds[i].VALUE);
+			if ( error != SNMP_ERR_NO_ERROR ) break;
+		}
+		if ( error == SNMP_ERR_NO_ERROR ) {
+			for ( i = 0; i < pdu->varBindCount; i++ ) {
+				error = set(&pdu->varBinds[i].OID, &pdu->varBinds[i].VALUE);
+				if ( error != SNMP_ERR_NO_ERROR ) break;
+			}
+		}
+		if ( error != SNMP_ERR_NO_ERROR ) {
+			error = v1 ? v1Error(error) : v2Error(error);
+		}
+	} else {
+		for ( i = 0; i < pdu->varBindCount; i++ ) {
+			SNMP_VARBIND *vb = pdu->varBinds + i;
+			if ( pdu->type == SNMP_PDU_GET_NEXT ) {
+				error = getNextBinding(pdu, vb);
+			} else {
+				error = getBinding(pdu, vb);
+				if ( error == SNMP_ERR_NO_SUCH_NAME && !v1 ) {
+					setException(&vb->VALUE, findSubtree(vb->OID.data, vb->OID.size) != NULL
+						     ? SNMP_SYNTAX_NO_SUCH_INSTANCE : SNMP_SYNTAX_NO_SUCH_OBJECT);
+					error = SNMP_ERR_NO_ERROR;
+				}
+			}
+			if ( error != SNMP_ERR_NO_ERROR ) {
+				if ( v1 ) error = v1Error(error);
+				break;
+			}
+		}
+	}
+	//
+	pdu->type = SNMP_PDU_RESPONSE;
+	pdu->error = error;
+	pdu->errorIndex = (error == SNMP_ERR_NO_ERROR) ? 0 : i + 1;
+}
+
+AgentuinoTable::AgentuinoTable()
+{
+	_columns = NULL;
+	_columnCount = 0;
+	_rows = NULL;
+	_count = 0;
+	_capacity = 0;
+	_valueCallback = NULL;
+	_valueArg = NULL;
+}
+
+AgentuinoTable::~AgentuinoTable()
+{
+	SNMP_FREE(_rows);
+}
+
+/**
+ * @brief Describe the columns of the table.
+ * @param columns - Column definitions ordered by ascending id.
+ * @param columnCount - Number of columns.
+ * @return - SNMP_API_STAT_OID_INVALID if there is no column or the ids are
+ *	     not ascending.
+ */ 
+SNMP_API_STAT_CODES AgentuinoTable::begin(const SNMP_TABLE_COLUMN *columns, uint8_t columnCount)
+{
+	if ( columnCount == 0 ) {
+		return SNMP_API_STAT_OID_INVALID;
+	}
+	for ( uint8_t i = 1; i < columnCount; i++ ) {
+		if ( columns[i].id <= columns[i - 1].id ) {
+			return SNMP_API_STAT_OID_INVALID;
+		}
+	}
+	_columns = columns;
+	_columnCount = columnCount;
+	return SNMP_API_STAT_SUCCESS;
+}
+
+/**
+ * @brief Serve the cells through a callback instead of the row fields at
+ *	  column.offset, e.g. for rows that are computed on request.
+ * @param callback - Cell callback, NULL returns to the row fields.
+ * @param arg - Passed back to callback.
+ * @return void
+ */ 
+void AgentuinoTable::onValue(onTableValueCallback callback, void *arg)
+{
+	_valueCallback = callback;
+	_valueArg = arg;
+}
+
+/**
+ * @brief Add a row to the index.
+ * @param index - Sub-identifiers of the row index (e.g. ifIndex, or the four
+ *		  arcs of an IpAddress).
+ * @param indexSize - Number of sub-identifiers.
+ * @param row - Row passed to the cell access, must stay valid while indexed.
+ * @return - SNMP_API_STAT_OID_TOO_BIG if the index does not fit
+ *	     SNMP_MAX_TABLE_INDEX bytes, SNMP_API_STAT_MALLOC_ERR.
+ */ 
+SNMP_API_STAT_CODES AgentuinoTable::addRow(const uint32_t *index, uint8_t indexSize, void *row)
+{
+	SNMP_TABLE_ROW entry;
+
+	if ( indexSize == 0 ) {
+		return SNMP_API_STAT_OID_INVALID;
+	}
+	// the column takes one arc of the instance
+	if ( indexSize >= SNMP_MAX_INSTANCE_ARCS ) {
+		return SNMP_API_STAT_OID_TOO_BIG;
+	}
+	entry.oidSize = encodeArcs(index, indexSize, entry.oid, sizeof(entry.oid));
+	if ( entry.oidSize == 0 ) {
+		return SNMP_API_STAT_OID_TOO_BIG;
+	}
+	entry.row = row;
+	return insertSorted(&_rows, &_count, &_capacity, &entry);
+}
+
+SNMP_API_STAT_CODES AgentuinoTable::removeRow(const uint32_t *index, uint8_t indexSize)
+{
+	bool exact;
+	uint16_t pos = lookup(index, indexSize, &exact);
+
+	if ( !exact ) {
+		return SNMP_API_STAT_NO_SUCH_NAME;
+	}
+	memmove(_rows + pos, _rows + pos + 1, sizeof(SNMP_TABLE_ROW) * (_count - pos - 1));
+	_count--;
+	return SNMP_API_STAT_SUCCESS;
+}
+
+void *AgentuinoTable::findRow(const uint32_t *index, uint8_t indexSize)
+{
+	bool exact;
+	uint16_t pos = lookup(index, indexSize, &exact);
+
+	return exact ? _rows[pos].row : NULL;
+}
+
+/**
+ * @brief Rebuild the index from a row iterator. Rows arriving in index order
+ *	  are appended without moving the others.
+ * @param iterator - Called with NULL for the first row, then with the previous row.
+ * @param arg - Passed back to iterator.
+ * @return - The status of the first addRow() that failed, the rows added
+ *	     until then stay indexed.
+ */ 
+SNMP_API_STAT_CODES AgentuinoTable::load(onTableRowCallback iterator, void *arg)
+{
+	SNMP_API_STAT_CODES status;
+	SNMP_INSTANCE index;
+	void *row;
+
+	_count = 0;
+	for ( row = iterator(NULL, &index, arg); row != NULL; row = iterator(row, &index, arg) ) {
+		status = addRow(index.arcs, index.size, row);
+		if ( status != SNMP_API_STAT_SUCCESS ) {
+			return status;
+		}
+	}
+	return SNMP_API_STAT_SUCCESS;
+}
+
+// linear: tables have a handful of columns
+const SNMP_TABLE_COLUMN *AgentuinoTable::column(uint32_t id)
+{
+	for ( uint8_t i = 0; i < _columnCount && _columns[i].id <= id; i++ ) {
+		if ( _columns[i].id == id ) return _columns + i;
+	}
+	return NULL;
+}
+
+// position of the first row not ordered before index, exact if it is index itself
+uint16_t AgentuinoTable::lookup(const uint32_t *index, uint8_t indexSize, bool *exact)
+{
+	byte data[SNMP_MAX_INSTANCE_ARCS * 5];
+	size_t size = encodeArcs(index, indexSize, data, sizeof(data));
+	uint16_t pos = lowerBound(_rows, _count, data, size);
+
+	*exact = size > 0 && pos < _count
+		&& snmpOidCompare(_rows[pos].oid, _rows[pos].oidSize, data, size) == 0;
+	return pos;
+}
+
+SNMP_ERR_CODES AgentuinoTable::cell(SNMP_PDU_TYPES type, SNMP_TABLE_ROW *row,
+				    const SNMP_TABLE_COLUMN *column, SNMP_VALUE *value)
+{
+	SNMP_OBJECT object;
+
+	if ( _valueCallback != NULL ) {
+		if ( type == SNMP_PDU_SET || type == SNMP_PDU_TEST_SET ) {
+			if ( column->access != SNMP_ACCESS_READ_WRITE ) return SNMP_ERR_READ_ONLY;
+			if ( value->syntax != column->syntax ) return SNMP_ERR_WRONG_TYPE;
+		}
+		return _valueCallback(type, row->row, column, value, _valueArg);
+	}
+	memset(&object, 0, sizeof(object));
+	object.syntax = column->syntax;
+	object.access = column->access;
+	object.var = (byte *) row->row + column->offset;
+	object.varSize = column->size;
+	if ( type == SNMP_PDU_SET ) {
+		return AgentuinoMib::setValue(&object, value);
+	}
+	if ( type == SNMP_PDU_TEST_SET ) {
+		return AgentuinoMib::checkValue(&object, value);
+	}
+	return AgentuinoMib::getValue(&object, value);
+}
+
+/**
+ * @brief GET-NEXT in column-major order: the rows of the requested column
+ *	  after its index, then every row of the following columns. A cell
+ *	  whose callback answers SNMP_ERR_NO_SUCH_NAME is a hole and skipped.
+ * @param instance - Requested column.index (possibly partial), replaced by
+ *		     the successor.
+ * @param value - Receives the value of the successor.
+ * @return - SNMP_ERR_NO_SUCH_NAME after the last cell.
+ */ 
+SNMP_ERR_CODES AgentuinoTable::next(SNMP_INSTANCE *instance, SNMP_VALUE *value)
+{
+	SNMP_INSTANCE index;
+	SNMP_ERR_CODES error;
+	uint8_t c = 0;
+	uint16_t pos = 0;
+	bool exact;
+
+	if ( _count == 0 ) {
+		return SNMP_ERR_NO_SUCH_NAME;
+	}
+	if ( instance->size ) {
+		while ( c < _columnCount && _columns[c].id < instance->arcs[0] ) c++;
+		if ( c < _columnCount && _columns[c].id == instance->arcs[0] && instance->size > 1 ) {
+			pos = lookup(instance->arcs + 1, instance->size - 1, &exact);
+			if ( exact ) pos++;
+		}
+	}
+	for ( ; c < _columnCount; c++, pos = 0 ) {
+		for ( ; pos < _count; pos++ ) {
+			error = cell(SNMP_PDU_GET, _rows + pos, _columns + c, value);
+			if ( error == SNMP_ERR_NO_SUCH_NAME ) continue;
+			if ( error != SNMP_ERR_NO_ERROR ) return error;
+			decodeInstance(_rows[pos].oid, _rows[pos].oidSize, &index);
+			instance->arcs[0] = _columns[c].id;
+			memcpy(instance->arcs + 1, index.arcs, sizeof(uint32_t) * index.size);
+			instance->size = index.size + 1;
+			return SNMP_ERR_NO_ERROR;
+		}
+	}
+	return SNMP_ERR_NO_SUCH_NAME;
+}
+
+SNMP_ERR_CODES AgentuinoTable::handler(SNMP_PDU_TYPES type, SNMP_INSTANCE *instance,
+				       SNMP_VALUE *value, void *arg)
+{
+	AgentuinoTable *table = (AgentuinoTable *) arg;
+	const SNMP_TABLE_COLUMN *column;
+	uint16_t pos;
+	bool exact;
+
+	if ( type == SNMP_PDU_GET_NEXT ) {
+		return table->next(instance, value);
+	}
+	if ( instance->size < 2 || (column = table->column(instance->arcs[0])) == NULL ) {
+		return SNMP_ERR_NO_SUCH_NAME;
+	}
+	pos = table->lookup(instance->arcs + 1, instance->size - 1, &exact);
+	if ( !exact ) {
+		return SNMP_ERR_NO_SUCH_NAME;
+	}
+	return table->cell(type, table->_rows + pos, column, value);
+}
@@ -0,0 +1,321 @@
+/*
+  AgentuinoPosix.cpp - BSD socket transport for the Agentuino SNMP Agent (host build).
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#if !defined(ARDUINO)
+
+#include "AgentuinoPosix.h"
+#include <errno.h>
+#include <ifaddrs.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#if defined(MSG_DONTWAIT)
+#define SNMP_POSIX_DONTWAIT	MSG_DONTWAIT
+#else
+#define SNMP_POSIX_DONTWAIT	0
+#endif
+
+AgentuinoPosix::AgentuinoPosix()
+{
+	_fd = -1;
+	memset(_bindIp, 0, 4);
+	_reusePort = false;
+	_localIpValid = false;
+	_rxHead = _rxCount = 0;
+	_current = NULL;
+	_txCount = 0;
+	_txErrors = 0;
+	_batching = false;
+}
+
+AgentuinoPosix::~AgentuinoPosix()
+{
+	stop();
+}
+
+void AgentuinoPosix::bindAddress(const uint8_t *ip)
+{
+	memcpy(_bindIp, ip, 4);
+}
+
+SNMP_API_STAT_CODES AgentuinoPosix::begin(uint16_t port)
+{
+	struct sockaddr_in addr;
+	int on = 1;
+
+	stop();
+	_fd = socket(AF_INET, SOCK_DGRAM, 0);
+	if ( _fd < 0 ) {
+		return SNMP_API_STAT_SOCKET_ERR;
+	}
+	// the port stays exclusive unless a worker pool shares it on purpose
+	if ( _reusePort ) {
+		setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+#if defined(SO_REUSEPORT)
+		if ( setsockopt(_fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) < 0 ) {
+			stop();
+			return SNMP_API_STAT_SOCKET_ERR;
+		}
+#endif
+	}
+	//
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	memcpy(&addr.sin_addr.s_addr, _bindIp, 4);
+	if ( bind(_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ) {
+		stop();
+		return SNMP_API_STAT_SOCKET_ERR;
+	}
+	return SNMP_API_STAT_SUCCESS;
+}
+
+void AgentuinoPosix::stop(void)
+{
+	if ( _fd >= 0 ) {
+		close(_fd);
+		_fd = -1;
+	}
+	_rxHead = _rxCount = 0;
+	_current = NULL;
+	_txCount = 0;
+	_txErrors = 0;
+	_batching = false;
+}
+
+/**
+ * @brief Receive every pending datagram up to SNMP_POSIX_BATCH without
+ *	  blocking, with a single recvmmsg() on Linux.
+ * @return - false if nothing was pending.
+ */ 
+bool AgentuinoPosix::receiveBatch(void)
+{
+#if defined(__linux__)
+	struct mmsghdr msgs[SNMP_POSIX_BATCH];
+	struct iovec iov[SNMP_POSIX_BATCH];
+	struct sockaddr_in from[SNMP_POSIX_BATCH];
+	int n;
+
+	memset(msgs, 0, sizeof(msgs));
+	for ( int i = 0; i < SNMP_POSIX_BATCH; i++ ) {
+		iov[i].iov_base = _rx[i].data;
+		iov[i].iov_len = sizeof(_rx[i].data);
+		msgs[i].msg_hdr.msg_iov = iov + i;
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		msgs[i].msg_hdr.msg_name = from + i;
+		msgs[i].msg_hdr.msg_namelen = sizeof(from[i]);
+	}
+	do {
+		// MSG_TRUNC makes msg_len the size on the wire
+		n = recvmmsg(_fd, msgs, SNMP_POSIX_BATCH, MSG_DONTWAIT | MSG_TRUNC, NULL);
+	} while ( n < 0 && errno == EINTR );
+	if ( n <= 0 ) return false;
+	for ( int i = 0; i < n; i++ ) {
+		_rx[i].size = msgs[i].msg_len;
+		memcpy(_rx[i].ip, &from[i].sin_addr.s_addr, 4);
+		_rx[i].port = ntohs(from[i].sin_port);
+	}
+#else
+	struct sockaddr_in from;
+	socklen_t fromLen = sizeof(from);
+	ssize_t n;
+
+	do {
+		n = recvfrom(_fd, _rx[0].data, sizeof(_rx[0].data), MSG_DONTWAIT | MSG_TRUNC,
+			     (struct sockaddr *)&from, &fromLen);
+	} while ( n < 0 && errno == EINTR );
+	if ( n <= 0 ) return false;
+	_rx[0].size = (int)n;
+	memcpy(_rx[0].ip, &from.sin_addr.s_addr, 4);
+	_rx[0].port = ntohs(from.sin_port);
+	n = 1;
+#endif
+	_rxHead = 0;
+	_rxCount = n;
+	return true;
+}
+
+/**
+ * @brief Fetch the next datagram without blocking.
+ * @return - Size of the datagram on the wire (may exceed SNMP_UDP_MAX_PAYLOAD), 0 if none.
+ */ 
+int AgentuinoPosix::parsePacket(void)
+{
+	_current = NULL;
+	if ( _fd < 0 ) return 0;
+	if ( _rxCount == 0 && !receiveBatch() ) return 0;
+	_current = _rx + _rxHead++;
+	_rxCount--;
+	return _current->size;
+}
+
+int AgentuinoPosix::read(byte *buffer, size_t len)
+{
+	int n;
+
+	if ( _current == NULL ) return 0;
+	n = _current->size;
+	if ( n > (int)sizeof(_current->data) ) n = sizeof(_current->data);
+	if ( (size_t)n > len ) n = len;
+	memcpy(buffer, _current->data, n);
+	return n;
+}
+
+void AgentuinoPosix::remote(uint8_t *ip, uint16_t *port)
+{
+	if ( _current == NULL ) {
+		memset(ip, 0, 4);
+		*port = 0;
+		return;
+	}
+	memcpy(ip, _current->ip, 4);
+	*port = _current->port;
+}
+
+SNMP_API_STAT_CODES AgentuinoPosix::send(const uint8_t *ip, uint16_t port,
+					 const byte *buffer, size_t len)
+{
+	if ( _fd < 0 ) return SNMP_API_STAT_SOCKET_ERR;
+	if ( _batching && len <= SNMP_UDP_MAX_PAYLOAD ) {
+		if ( _txCount == SNMP_POSIX_BATCH ) _txErrors += sendQueued();
+		SNMP_POSIX_DATAGRAM *d = _tx + _txCount++;
+		memcpy(d->data, buffer, len);
+		d->size = len;
+		memcpy(d->ip, ip, 4);
+		d->port = port;
+		return SNMP_API_STAT_SUCCESS;
+	}
+	return sendUnbatched(ip, port, buffer, len);
+}
+
+SNMP_API_STAT_CODES AgentuinoPosix::sendUnbatched(const uint8_t *ip, uint16_t port,
+						  const byte *buffer, size_t len)
+{
+	struct sockaddr_in to;
+	ssize_t n;
+
+	if ( _fd < 0 ) return SNMP_API_STAT_SOCKET_ERR;
+	memset(&to, 0, sizeof(to));
+	to.sin_family = AF_INET;
+	to.sin_port = htons(port);
+	memcpy(&to.sin_addr.s_addr, ip, 4);
+	// a full socket buffer fails the send instead of stalling the agent,
+	// traps are retried from the queue
+	do {
+		n = sendto(_fd, buffer, len, SNMP_POSIX_DONTWAIT, (struct sockaddr *)&to, sizeof(to));
+	} while ( n < 0 && errno == EINTR );
+	return n == (ssize_t)len ? SNMP_API_STAT_SUCCESS : SNMP_API_STAT_SOCKET_ERR;
+}
+
+// from now on send() queues, flush() sends the queue
+void AgentuinoPosix::beginBatch(void)
+{
+	_batching = true;
+	_txErrors = 0;
+}
+
+/**
+ * @brief Send the queue and stop batching.
+ * @return - SNMP_API_STAT_SOCKET_ERR if the socket refused any datagram
+ *	     queued since beginBatch().
+ */ 
+SNMP_API_STAT_CODES AgentuinoPosix::flush(void)
+{
+	_txErrors += sendQueued();
+	_batching = false;
+	return _txErrors ? SNMP_API_STAT_SOCKET_ERR : SNMP_API_STAT_SUCCESS;
+}
+
+/**
+ * @brief Send the queued datagrams, with sendmmsg() on Linux. A datagram
+ *	  the socket refuses is dropped like a lost UDP packet.
+ * @return - The number of datagrams refused.
+ */ 
+uint8_t AgentuinoPosix::sendQueued(void)
+{
+	uint8_t refused = 0;
+
+	struct sockaddr_in to[SNMP_POSIX_BATCH];
+	int i;
+
+	memset(to, 0, sizeof(to));
+	for ( i = 0; i < _txCount; i++ ) {
+		to[i].sin_family = AF_INET;
+		to[i].sin_port = htons(_tx[i].port);
+		memcpy(&to[i].sin_addr.s_addr, _tx[i].ip, 4);
+	}
+#if defined(__linux__)
+	struct mmsghdr msgs[SNMP_POSIX_BATCH];
+	struct iovec iov[SNMP_POSIX_BATCH];
+
+	memset(msgs, 0, sizeof(msgs));
+	for ( i = 0; i < _txCount; i++ ) {
+		iov[i].iov_base = _tx[i].data;
+		iov[i].iov_len = _tx[i].size;
+		msgs[i].msg_hdr.msg_iov = iov + i;
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		msgs[i].msg_hdr.msg_name = to + i;
+		msgs[i].msg_hdr.msg_namelen = sizeof(to[i]);
+	}
+	for ( i = 0; i < _txCount; ) {
+		int n = sendmmsg(_fd, msgs + i, _txCount - i, 0);
+		if ( n < 0 && errno == EINTR ) continue;
+		// skip the datagram that failed
+		if ( n <= 0 ) refused++;
+		i += n > 0 ? n : 1;
+	}
+#else
+	for ( i = 0; i < _txCount; i++ ) {
+		ssize_t n;
+		do {
+			n = sendto(_fd, _tx[i].data, _tx[i].size, 0, (struct sockaddr *)(to + i), sizeof(to[i]));
+		} while ( n < 0 && errno == EINTR );
+		if ( n != _tx[i].size ) refused++;
+	}
+#endif
+	_txCount = 0;
+	return refused;
+}
+
+/**
+ * @brief Agent address: the bind address, or else the first non-loopback IPv4 interface.
+ */ 
+void AgentuinoPosix::localIP(uint8_t *ip)
+{
+	if ( _bindIp[0] || _bindIp[1] || _bindIp[2] || _bindIp[3] ) {
+		memcpy(ip, _bindIp, 4);
+		return;
+	}
+	if ( !_localIpValid ) {
+		struct ifaddrs *list, *ifa;
+
+		memset(_localIp, 0, 4);
+		if ( getifaddrs(&list) == 0 ) {
+			for ( ifa = list; ifa != NULL; ifa = ifa->ifa_next ) {
+				if ( ifa->ifa_addr == NULL || ifa->ifa_addr->sa_family != AF_INET ) continue;
+				struct sockaddr_in *in = (struct sockaddr_in *)ifa->ifa_addr;
+				if ( ((byte *)&in->sin_addr.s_addr)[0] == 127 ) continue;
+				memcpy(_localIp, &in->sin_addr.s_addr, 4);
+				break;
+			}
+			freeifaddrs(list);
+		}
+		_localIpValid = true;
+	}
+	memcpy(ip, _localIp, 4);
+}
+
+#endif
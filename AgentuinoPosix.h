@@ -0,0 +1,78 @@
+/*
+  AgentuinoPosix.h - BSD socket transport for the Agentuino SNMP Agent (host build).
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef AgentuinoPosix_h
+#define AgentuinoPosix_h
+
+#include "Agentuino.h"
+
+// largest UDP payload on a 1500 byte Ethernet MTU
+#define SNMP_UDP_MAX_PAYLOAD	1472
+
+// datagrams received (recvmmsg) and queued responses sent (sendmmsg) per system call
+#ifndef SNMP_POSIX_BATCH
+#define SNMP_POSIX_BATCH	16
+#endif
+
+typedef struct SNMP_POSIX_DATAGRAM {
+	byte data[SNMP_UDP_MAX_PAYLOAD];
+	int size;		// size on the wire, may exceed data
+	uint8_t ip[4];
+	uint16_t port;
+};
+
+class AgentuinoPosix : public AgentuinoTransport {
+public:
+	AgentuinoPosix();
+	~AgentuinoPosix();
+	SNMP_API_STAT_CODES begin(uint16_t port);
+	int parsePacket(void);
+	int read(byte *buffer, size_t len);
+	void remote(uint8_t *ip, uint16_t *port);
+	SNMP_API_STAT_CODES send(const uint8_t *ip, uint16_t port,
+				 const byte *buffer, size_t len);
+	void localIP(uint8_t *ip);
+	void beginBatch(void);
+	SNMP_API_STAT_CODES flush(void);
+	SNMP_API_STAT_CODES sendUnbatched(const uint8_t *ip, uint16_t port,
+					  const byte *buffer, size_t len);
+	int fd(void) { return _fd; }
+	// bind to one local address instead of INADDR_ANY (call before begin)
+	void bindAddress(const uint8_t *ip);
+	// let several sockets bind the same port, the kernel spreads the requests (Linux)
+	void reusePort(bool on) { _reusePort = on; }
+	void stop(void);
+
+private:
+	int _fd;
+	uint8_t _bindIp[4];
+	bool _reusePort;
+	uint8_t _localIp[4];
+	bool _localIpValid;
+	// received datagrams, parsePacket() hands them out in order
+	SNMP_POSIX_DATAGRAM _rx[SNMP_POSIX_BATCH];
+	uint8_t _rxHead;
+	uint8_t _rxCount;
+	SNMP_POSIX_DATAGRAM *_current;	// datagram returned by parsePacket()
+	// responses queued while batching
+	SNMP_POSIX_DATAGRAM _tx[SNMP_POSIX_BATCH];
+	uint8_t _txCount;
+	uint16_t _txErrors;	// queued datagrams refused since beginBatch()
+	bool _batching;
+	bool receiveBatch(void);
+	uint8_t sendQueued(void);
+};
+
+#endif
@@ -0,0 +1,154 @@
+/*
+  AgentuinoWorkers.cpp - multi-core worker pool for the Agentuino SNMP Agent (Linux host build).
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#if !defined(ARDUINO) && defined(__linux__)
+
+#include "AgentuinoWorkers.h"
+#include "AgentuinoEventLoop.h"
+#include <sched.h>
+#include <unistd.h>
+
+// how often an idle worker checks for stop(), in ms
+#define SNMP_WORKER_POLL_MS	100
+
+AgentuinoWorkers::AgentuinoWorkers()
+{
+	_count = 0;
+	_running = false;
+}
+
+AgentuinoWorkers::~AgentuinoWorkers()
+{
+	stop();
+}
+
+/**
+ * @brief Start the workers. The registry of the given agent is frozen
+ *	  first (see AgentuinoMib::freeze()), so register every object before.
+ * @param registry - Agent holding the objects, must outlive the pool.
+ * @param count - Number of workers, at most SNMP_MAX_WORKERS.
+ * @param port - UDP port shared by all workers.
+ * @param getCommName - Community for GET, GET-NEXT and GET-BULK.
+ * @param setCommName - Community for SET.
+ * @param pinCores - Pin worker i to core i modulo the online cores.
+ * @return - The API status code; on error no worker is left running.
+ */ 
+SNMP_API_STAT_CODES AgentuinoWorkers::begin(AgentuinoClass *registry, uint8_t count, uint16_t port,
+					    const char *getCommName, const char *setCommName,
+					    bool pinCores)
+{
+	uint8_t nms[4] = { 0, 0, 0, 0 };
+	long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	SNMP_API_STAT_CODES status = SNMP_API_STAT_SUCCESS;
+
+	stop();
+	if ( count == 0 || count > SNMP_MAX_WORKERS ) {
+		return SNMP_API_STAT_MALLOC_ERR;
+	}
+	registry->mib()->freeze();
+	millis();	// starts the host clock before any thread reads it
+	_running = true;
+	for ( _count = 0; _count < count && status == SNMP_API_STAT_SUCCESS; _count++ ) {
+		SNMP_WORKER *w = _workers + _count;
+
+		w->pool = this;
+		w->started = false;
+		w->requests = 0;
+		w->cacheHits = 0;
+		w->cacheMisses = 0;
+		w->cpu = (pinCores && cores > 0) ? _count % cores : -1;
+		w->transport = new AgentuinoPosix();
+		w->agent = new AgentuinoClass();
+		w->transport->reusePort(true);
+		w->agent->setTransport(w->transport);
+		w->agent->shareMib(registry);
+		status = w->agent->begin(getCommName, setCommName, "", 0, nms, port);
+		if ( status != SNMP_API_STAT_SUCCESS ) continue;
+		if ( pthread_create(&w->thread, NULL, run, w) != 0 ) {
+			status = SNMP_API_STAT_MALLOC_ERR;
+			continue;
+		}
+		w->started = true;
+		if ( w->cpu >= 0 ) {
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			CPU_SET(w->cpu, &set);
+			pthread_setaffinity_np(w->thread, sizeof(set), &set);
+		}
+	}
+	if ( status != SNMP_API_STAT_SUCCESS ) {
+		stop();
+	}
+	return status;
+}
+
+// worker thread: its own event loop around its own agent
+void *AgentuinoWorkers::run(void *arg)
+{
+	SNMP_WORKER *w = (SNMP_WORKER *) arg;
+	AgentuinoEventLoop events;
+
+	if ( events.add(w->agent) != SNMP_API_STAT_SUCCESS ) {
+		return NULL;
+	}
+	while ( w->pool->_running.load(std::memory_order_relaxed) ) {
+		if ( events.runOnce(SNMP_WORKER_POLL_MS) < 0 ) break;
+		// the agent counters belong to this thread, stats() reads the copies
+		w->requests.store(w->agent->requestCount(), std::memory_order_relaxed);
+		w->cacheHits.store(w->agent->responseCacheHits(), std::memory_order_relaxed);
+		w->cacheMisses.store(w->agent->responseCacheMisses(), std::memory_order_relaxed);
+	}
+	return NULL;
+}
+
+void AgentuinoWorkers::stop(void)
+{
+	_running = false;
+	for ( uint8_t i = 0; i < _count; i++ ) {
+		SNMP_WORKER *w = _workers + i;
+
+		if ( w->started ) {
+			pthread_join(w->thread, NULL);
+			w->started = false;
+		}
+		delete w->agent;
+		delete w->transport;
+	}
+	_count = 0;
+}
+
+/**
+ * @brief Counters of one worker, read while it runs. The worker publishes
+ *	  them after each batch it handles; each value is exact as of then,
+ *	  together they are a snapshot only approximately.
+ */ 
+SNMP_WORKER_STATS AgentuinoWorkers::stats(uint8_t i)
+{
+	SNMP_WORKER_STATS s;
+
+	memset(&s, 0, sizeof(s));
+	s.cpu = -1;
+	if ( i < _count ) {
+		SNMP_WORKER *w = _workers + i;
+
+		s.requests = w->requests.load(std::memory_order_relaxed);
+		s.cacheHits = w->cacheHits.load(std::memory_order_relaxed);
+		s.cacheMisses = w->cacheMisses.load(std::memory_order_relaxed);
+		s.cpu = w->cpu;
+	}
+	return s;
+}
+
+#endif
@@ -0,0 +1,77 @@
+/*
+  AgentuinoWorkers.h - multi-core worker pool for the Agentuino SNMP Agent (Linux host build).
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef AgentuinoWorkers_h
+#define AgentuinoWorkers_h
+
+#include "Agentuino.h"
+#include "AgentuinoPosix.h"
+#include <pthread.h>
+#include <atomic>
+
+#ifndef SNMP_MAX_WORKERS
+#define SNMP_MAX_WORKERS	64
+#endif
+
+typedef struct SNMP_WORKER_STATS {
+	uint32_t requests;	// datagrams handled
+	uint32_t cacheHits;	// answered from the retransmission cache
+	uint32_t cacheMisses;
+	int cpu;		// core the worker is pinned to, -1 if not pinned
+};
+
+class AgentuinoWorkers;
+
+typedef struct SNMP_WORKER {
+	AgentuinoClass *agent;
+	AgentuinoPosix *transport;
+	AgentuinoWorkers *pool;
+	pthread_t thread;
+	bool started;
+	int cpu;
+	// counters of agent, published by the worker thread after each batch
+	std::atomic<uint32_t> requests;
+	std::atomic<uint32_t> cacheHits;
+	std::atomic<uint32_t> cacheMisses;
+};
+
+//
+// Worker pool: count agents bound to the same port with SO_REUSEPORT, each
+// on its own thread with its own socket, buffers and response cache. The
+// kernel spreads the requests over the sockets by source address and port.
+// All of them answer from the registry of one agent, frozen by begin().
+class AgentuinoWorkers {
+public:
+	AgentuinoWorkers();
+	~AgentuinoWorkers();
+	// registry - agent whose objects are served (need not be begun itself)
+	// pinCores - pin worker i to core i modulo the online cores
+	SNMP_API_STAT_CODES begin(AgentuinoClass *registry, uint8_t count, uint16_t port,
+				  const char *getCommName, const char *setCommName,
+				  bool pinCores = false);
+	// stops and joins the threads, then releases the agents
+	void stop(void);
+	uint8_t count(void) { return _count; }
+	AgentuinoClass *worker(uint8_t i) { return i < _count ? _workers[i].agent : NULL; }
+	SNMP_WORKER_STATS stats(uint8_t i);
+
+private:
+	static void *run(void *arg);
+	SNMP_WORKER _workers[SNMP_MAX_WORKERS];
+	uint8_t _count;
+	std::atomic<bool> _running;
+};
+
+#endif
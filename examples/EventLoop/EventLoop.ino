@@ -0,0 +1,67 @@
+/**
+* Agentuino SNMP Agent Library Prototyping...
+*
+* Event driven agent for the Linux host build: instead of calling
+* Agentuino.listen() from loop() all the time, the process sleeps in
+* epoll_wait() until a request arrives or a timer expires.
+*/
+
+#if defined(ARDUINO) || !defined(__linux__)
+#error "EventLoop needs the Linux host build (see README.txt)"
+#endif
+
+#include <Ethernet.h>          // Include the Ethernet library
+#include <SPI.h>
+#include <Agentuino.h>
+#include <AgentuinoEventLoop.h>
+
+static byte mac[] = { 0xDE, 0xAD, 0xBE, 0xEF, 0xFE, 0xED };
+static byte ip[] = { 192, 168, 0, 6 };
+//
+// RFC1213-MIB OIDs
+// .iso.org.dod.internet.mgmt.mib-2.system.sysDescr (.1.3.6.1.2.1.1.1)
+typedef SNMP_OID_LITERAL<1,3,6,1,2,1,1,1,0> sysDescr;    // read-only  (DisplayString)
+// .iso.org.dod.internet.mgmt.mib-2.system.sysUpTime (.1.3.6.1.2.1.1.3)
+typedef SNMP_OID_LITERAL<1,3,6,1,2,1,1,3,0> sysUpTime;   // read-only  (TimeTicks)
+// .iso.org.dod.internet.mgmt.mib-2.system.sysName (.1.3.6.1.2.1.1.5)
+typedef SNMP_OID_LITERAL<1,3,6,1,2,1,1,5,0> sysName;     // read-write (DisplayString)
+//
+// RFC1213 local values
+static char locDescr[]              = "Agentuino, a light-weight SNMP Agent.";  // read-only (static)
+static uint32_t locUpTime           = 0;                                        // read-only
+static char locName[20]             = "Agentuino";                              // read/write
+
+static AgentuinoEventLoop events;
+
+// sysUpTime - hundredths of a second, advanced by a one second timer
+static void tick(void *)
+{
+  locUpTime += 100;
+}
+
+void setup()
+{
+  Serial.begin(9600);
+  Ethernet.begin(mac, ip);
+  uint8_t nms[] = {192, 168,0,100};
+  //
+  if ( Agentuino.begin(true, nms) != SNMP_API_STAT_SUCCESS ) {
+    Serial.println(F("begin failed"));
+    return;
+  }
+  Agentuino.addObject(sysDescr::data, sysDescr::size, SNMP_SYNTAX_OCTETS, SNMP_ACCESS_STATIC, locDescr);
+  Agentuino.addObject(sysUpTime::data, sysUpTime::size, SNMP_SYNTAX_TIME_TICKS, SNMP_ACCESS_READ_ONLY, &locUpTime);
+  Agentuino.addObject(sysName::data, sysName::size, SNMP_SYNTAX_OCTETS, SNMP_ACCESS_READ_WRITE, locName, sizeof(locName));
+  //
+  // requests wake the loop up through the agent socket,
+  // the up-time counter and the trap conditions through timers
+  events.add(&Agentuino);
+  events.addTimer(1000, tick);
+  events.addTrapTimer(&Agentuino, 100);
+  events.run();
+}
+
+void loop()
+{
+  // never reached, events.run() does not return
+}
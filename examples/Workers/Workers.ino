@@ -0,0 +1,75 @@
+/**
+* Agentuino SNMP Agent Library Prototyping...
+*
+* Multi-core agent for the Linux host build: one worker per core, all bound
+* to the same port with SO_REUSEPORT and answering from one frozen registry.
+* The main thread only prints the per-worker counters.
+*/
+
+#if defined(ARDUINO) || !defined(__linux__)
+#error "Workers needs the Linux host build (see README.txt)"
+#endif
+
+#include <Ethernet.h>          // Include the Ethernet library
+#include <SPI.h>
+#include <Agentuino.h>
+#include <AgentuinoWorkers.h>
+#include <unistd.h>
+
+static byte mac[] = { 0xDE, 0xAD, 0xBE, 0xEF, 0xFE, 0xED };
+static byte ip[] = { 192, 168, 0, 6 };
+//
+// RFC1213-MIB OIDs
+// .iso.org.dod.internet.mgmt.mib-2.system.sysDescr (.1.3.6.1.2.1.1.1)
+typedef SNMP_OID_LITERAL<1,3,6,1,2,1,1,1,0> sysDescr;    // read-only  (DisplayString)
+// .iso.org.dod.internet.mgmt.mib-2.system.sysContact (.1.3.6.1.2.1.1.4)
+typedef SNMP_OID_LITERAL<1,3,6,1,2,1,1,4,0> sysContact;  // read-only  (DisplayString)
+// .iso.org.dod.internet.mgmt.mib-2.system.sysName (.1.3.6.1.2.1.1.5)
+typedef SNMP_OID_LITERAL<1,3,6,1,2,1,1,5,0> sysName;     // read-only  (DisplayString)
+// .iso.org.dod.internet.mgmt.mib-2.system.sysLocation (.1.3.6.1.2.1.1.6)
+typedef SNMP_OID_LITERAL<1,3,6,1,2,1,1,6,0> sysLocation; // read-only  (DisplayString)
+// .iso.org.dod.internet.mgmt.mib-2.system.sysServices (.1.3.6.1.2.1.1.7)
+typedef SNMP_OID_LITERAL<1,3,6,1,2,1,1,7,0> sysServices; // read-only  (Integer)
+//
+// RFC1213 local values
+static char locDescr[]              = "Agentuino, a light-weight SNMP Agent.";  // read-only (static)
+static char locContact[20]          = "Petr Domorazek";                         // read-only (static)
+static char locName[20]             = "Agentuino";                              // read-only (static)
+static char locLocation[20]         = "Czech Republic";                         // read-only (static)
+static int32_t locServices          = 6;                                        // read-only (static)
+
+static AgentuinoWorkers workers;
+
+void setup()
+{
+  Serial.begin(9600);
+  Ethernet.begin(mac, ip);
+  //
+  // the registry lives in Agentuino, which itself is never begun;
+  // workers.begin() freezes it, so every object is added first
+  Agentuino.addObject(sysDescr::data, sysDescr::size, SNMP_SYNTAX_OCTETS, SNMP_ACCESS_STATIC, locDescr);
+  Agentuino.addObject(sysContact::data, sysContact::size, SNMP_SYNTAX_OCTETS, SNMP_ACCESS_STATIC, locContact);
+  Agentuino.addObject(sysName::data, sysName::size, SNMP_SYNTAX_OCTETS, SNMP_ACCESS_STATIC, locName);
+  Agentuino.addObject(sysLocation::data, sysLocation::size, SNMP_SYNTAX_OCTETS, SNMP_ACCESS_STATIC, locLocation);
+  Agentuino.addObject(sysServices::data, sysServices::size, SNMP_SYNTAX_INT, SNMP_ACCESS_STATIC, &locServices);
+  //
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  if ( workers.begin(&Agentuino, cores > 0 ? cores : 1, SNMP_DEFAULT_PORT,
+                     "public", "private", true) != SNMP_API_STAT_SUCCESS ) {
+    Serial.println(F("workers failed to start"));
+  }
+}
+
+void loop()
+{
+  delay(10000);
+  for ( uint8_t i = 0; i < workers.count(); i++ ) {
+    SNMP_WORKER_STATS s = workers.stats(i);
+    Serial.print(F("worker "));
+    Serial.print(i);
+    Serial.print(F(" cpu "));
+    Serial.print(s.cpu);
+    Serial.print(F(" requests "));
+    Serial.println(s.requests);
+  }
+}
@@ -0,0 +1,83 @@
+/*
+  Arduino.cpp - Minimal Arduino core replacement for the host build.
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+*/
+
+#include "Arduino.h"
+#include <time.h>
+
+HostSerial Serial;
+
+static struct timespec _start;
+static bool _started = false;
+
+static uint64_t elapsedMicros(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	if ( !_started ) {
+		_start = now;
+		_started = true;
+	}
+	return (uint64_t)(now.tv_sec - _start.tv_sec) * 1000000
+		+ (now.tv_nsec - _start.tv_nsec) / 1000;
+}
+
+unsigned long millis(void)
+{
+	return (unsigned long)(elapsedMicros() / 1000);
+}
+
+unsigned long micros(void)
+{
+	return (unsigned long)elapsedMicros();
+}
+
+void delay(unsigned long ms)
+{
+	struct timespec ts;
+
+	ts.tv_sec = ms / 1000;
+	ts.tv_nsec = (ms % 1000) * 1000000L;
+	while ( nanosleep(&ts, &ts) != 0 ) {
+	}
+}
+
+char *ultoa(unsigned long value, char *buffer, int radix)
+{
+	char tmp[sizeof(unsigned long) * 8 + 1];
+	int n = 0, i = 0;
+
+	do {
+		int d = value % radix;
+		tmp[n++] = d < 10 ? '0' + d : 'a' + d - 10;
+		value /= radix;
+	} while ( value );
+	while ( n ) buffer[i++] = tmp[--n];
+	buffer[i] = '\0';
+	return buffer;
+}
+
+char *utoa(unsigned int value, char *buffer, int radix)
+{
+	return ultoa(value, buffer, radix);
+}
+
+char *ltoa(long value, char *buffer, int radix)
+{
+	if ( value < 0 && radix == 10 ) {
+		buffer[0] = '-';
+		ultoa(0UL - (unsigned long)value, buffer + 1, radix);
+		return buffer;
+	}
+	return ultoa((unsigned long)value, buffer, radix);
+}
+
+char *itoa(int value, char *buffer, int radix)
+{
+	return ltoa(value, buffer, radix);
+}
@@ -0,0 +1,63 @@
+/*
+  Arduino.h - Minimal Arduino core replacement for building Agentuino
+  and its example sketches as native host executables.
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef uint8_t byte;
+typedef uint16_t word;
+typedef bool boolean;
+
+#define lowByte(w)	((uint8_t)((w) & 0xff))
+#define highByte(w)	((uint8_t)((w) >> 8))
+
+// program memory is ordinary memory on the host
+#define PROGMEM
+#define PGM_P		const char *
+#define F(s)		(s)
+#define strcpy_P	strcpy
+#define strncpy_P	strncpy
+#define strcmp_P	strcmp
+#define strncmp_P	strncmp
+#define strlen_P	strlen
+#define memcpy_P	memcpy
+#define pgm_read_byte(p)	(*(const uint8_t *)(p))
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+
+char *utoa(unsigned int value, char *buffer, int radix);
+char *ultoa(unsigned long value, char *buffer, int radix);
+char *itoa(int value, char *buffer, int radix);
+char *ltoa(long value, char *buffer, int radix);
+
+// Serial writes to stdout
+class HostSerial {
+public:
+	void begin(unsigned long baud) { (void)baud; }
+	void print(const char *s) { fputs(s, stdout); }
+	void print(char c) { fputc(c, stdout); }
+	void print(long n) { printf("%ld", n); }
+	void print(unsigned long n) { printf("%lu", n); }
+	void print(int n) { printf("%d", n); }
+	void print(unsigned int n) { printf("%u", n); }
+	void println(void) { fputs("\r\n", stdout); fflush(stdout); }
+	template <typename T> void println(T v) { print(v); println(); }
+};
+
+extern HostSerial Serial;
+
+#endif
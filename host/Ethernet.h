@@ -0,0 +1,26 @@
+/*
+  Ethernet.h - Ethernet shield stand-in for the host build. The host network
+  stack is already configured, so begin() only records the requested address.
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef Ethernet_h
+#define Ethernet_h
+
+#include "Arduino.h"
+
+class EthernetClass {
+public:
+	void begin(uint8_t *mac, uint8_t *ip) { (void)mac; memcpy(_ip, ip, 4); }
+	const uint8_t *localIP(void) { return _ip; }
+
+private:
+	uint8_t _ip[4];
+};
+
+extern EthernetClass Ethernet;
+
+#endif
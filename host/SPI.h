@@ -0,0 +1,8 @@
+/*
+  SPI.h - Empty stand-in for the host build.
+*/
+
+#ifndef SPI_h
+#define SPI_h
+
+#endif
@@ -0,0 +1,24 @@
+/*
+  main.cpp - Runs an Arduino sketch as a host process.
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+*/
+
+#include "Arduino.h"
+#include "Ethernet.h"
+
+EthernetClass Ethernet;
+
+void setup(void);
+void loop(void);
+
+int main(void)
+{
+	setup();
+	for (;;) {
+		loop();
+	}
+	return 0;
+}
@@ -0,0 +1,810 @@
+/*
+  loopback.cpp - Host test of the Agentuino SNMP Agent: requests encoded here
+  are handed to the agent through an in-memory transport and the responses,
+  traps and informs it sends are decoded and checked.
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+*/
+
+#include "Agentuino.h"
+#if defined(__linux__)
+#include "AgentuinoEventLoop.h"
+#include "AgentuinoWorkers.h"
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#endif
+#include <stddef.h>
+#include <unistd.h>
+#include <deque>
+#include <vector>
+
+typedef std::vector<byte> Bytes;
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+	if ( !(cond) ) { \
+		printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+		failures++; \
+	} } while(0)
+
+//
+// BER, written independently of SNMP_BER_WRITER so the agent's encoding is
+// compared against something it did not produce itself
+static Bytes tlv(byte tag, const Bytes &content)
+{
+	Bytes out(1, tag);
+	size_t len = content.size();
+
+	if ( len < 0x80 ) {
+		out.push_back(len);
+	} else if ( len < 0x100 ) {
+		out.push_back(0x81);
+		out.push_back(len);
+	} else {
+		out.push_back(0x82);
+		out.push_back(len >> 8);
+		out.push_back(len);
+	}
+	out.insert(out.end(), content.begin(), content.end());
+	return out;
+}
+
+static Bytes cat(const Bytes &a, const Bytes &b)
+{
+	Bytes out(a);
+
+	out.insert(out.end(), b.begin(), b.end());
+	return out;
+}
+
+static Bytes str(const char *s)
+{
+	return Bytes(s, s + strlen(s));
+}
+
+// two's complement in as few bytes as possible
+static Bytes integer(int64_t v, byte tag = SNMP_SYNTAX_INT)
+{
+	Bytes out;
+
+	do {
+		out.insert(out.begin(), (byte) v);
+		v >>= 8;
+	} while ( !((v == 0 && !(out[0] & 0x80)) || (v == -1 && (out[0] & 0x80))) );
+	return tlv(tag, out);
+}
+
+// unsigned application types need a leading zero when the top bit is set
+static Bytes unsignedInt(uint64_t v, byte tag)
+{
+	Bytes out;
+
+	do {
+		out.insert(out.begin(), (byte) v);
+		v >>= 8;
+	} while ( v );
+	if ( out[0] & 0x80 ) out.insert(out.begin(), 0);
+	return tlv(tag, out);
+}
+
+static Bytes oidBytes(std::initializer_list<uint32_t> list)
+{
+	std::vector<uint32_t> arcs(list);
+	Bytes out;
+
+	// the first two arcs share one sub-identifier
+	for ( size_t i = 1; i < arcs.size(); i++ ) {
+		uint32_t id = (i == 1) ? arcs[0] * 40 + arcs[1] : arcs[i];
+		Bytes sub(1, id & 0x7F);
+
+		while ( id >>= 7 ) sub.insert(sub.begin(), 0x80 | (id & 0x7F));
+		out.insert(out.end(), sub.begin(), sub.end());
+	}
+	return out;
+}
+
+static Bytes oid(std::initializer_list<uint32_t> arcs)
+{
+	return tlv(SNMP_SYNTAX_OID, oidBytes(arcs));
+}
+
+static Bytes null(void)
+{
+	return tlv(SNMP_SYNTAX_NULL, Bytes());
+}
+
+static Bytes varBind(const Bytes &name, const Bytes &value)
+{
+	return tlv(SNMP_SYNTAX_SEQUENCE, cat(name, value));
+}
+
+static Bytes message(int32_t version, const char *community, byte type, int32_t requestId,
+		     int32_t error, int32_t errorIndex, const Bytes &varBinds)
+{
+	Bytes pdu = cat(cat(integer(requestId), integer(error)), integer(errorIndex));
+
+	pdu = tlv(type, cat(pdu, tlv(SNMP_SYNTAX_SEQUENCE, varBinds)));
+	return tlv(SNMP_SYNTAX_SEQUENCE, cat(cat(integer(version), tlv(SNMP_SYNTAX_OCTETS, str(community))), pdu));
+}
+
+struct Reader {
+	const Bytes *data;
+	size_t pos, end;
+	bool ok;
+
+	// reads the next TLV, returns its tag and the range of its contents
+	byte next(size_t *start, size_t *stop) {
+		byte tag;
+		size_t len;
+
+		if ( !ok || pos + 2 > end ) { ok = false; return 0; }
+		tag = (*data)[pos++];
+		len = (*data)[pos++];
+		if ( len & 0x80 ) {
+			size_t n = len & 0x7F;
+			len = 0;
+			while ( n-- && pos < end ) len = (len << 8) | (*data)[pos++];
+		}
+		if ( pos + len > end ) { ok = false; return 0; }
+		*start = pos;
+		*stop = pos + len;
+		pos += len;
+		return tag;
+	}
+	int64_t integer(void) {
+		size_t s, e;
+		int64_t v;
+
+		next(&s, &e);
+		if ( !ok || s == e ) { ok = false; return 0; }
+		v = ((*data)[s] & 0x80) ? -1 : 0;
+		for ( ; s < e; s++ ) v = (v << 8) | (*data)[s];
+		return v;
+	}
+	Bytes bytes(byte *tag = NULL) {
+		size_t s, e;
+		byte t = next(&s, &e);
+
+		if ( tag != NULL ) *tag = t;
+		return ok ? Bytes(data->begin() + s, data->begin() + e) : Bytes();
+	}
+};
+
+struct VarBind {
+	Bytes oid;		// contents of the OID
+	byte type;
+	Bytes value;		// contents of the value
+};
+
+struct Message {
+	bool ok;
+	int64_t version;
+	Bytes community;
+	byte type;
+	int64_t requestId, error, errorIndex;
+	Bytes enterprise;	// SNMPv1 Trap-PDU only
+	int64_t generic, specific;
+	std::vector<VarBind> varBinds;
+};
+
+static Message decode(const Bytes &data)
+{
+	Message m;
+	Reader r = { &data, 0, data.size(), true };
+	size_t s, e;
+
+	m.varBinds.clear();
+	if ( r.next(&s, &e) != SNMP_SYNTAX_SEQUENCE ) { m.ok = false; return m; }
+	r.pos = s; r.end = e;
+	m.version = r.integer();
+	m.community = r.bytes();
+	m.type = r.next(&s, &e);
+	r.pos = s; r.end = e;
+	if ( m.type == SNMP_PDU_TRAP ) {
+		m.enterprise = r.bytes();
+		r.bytes();			// agent-addr
+		m.generic = r.integer();
+		m.specific = r.integer();
+		r.bytes();			// time-stamp
+		m.requestId = m.error = m.errorIndex = 0;
+	} else {
+		m.requestId = r.integer();
+		m.error = r.integer();
+		m.errorIndex = r.integer();
+	}
+	if ( r.next(&s, &e) != SNMP_SYNTAX_SEQUENCE ) r.ok = false;
+	r.pos = s; r.end = e;
+	while ( r.ok && r.pos < r.end ) {
+		Reader vb = r;
+		VarBind v;
+
+		vb.next(&s, &e);
+		r.pos = e;
+		vb.pos = s; vb.end = e;
+		v.oid = vb.bytes();
+		v.value = vb.bytes(&v.type);
+		r.ok = vb.ok;
+		m.varBinds.push_back(v);
+	}
+	m.ok = r.ok;
+	return m;
+}
+
+//
+// In-memory datagram transport: requests are queued by the test, whatever
+// the agent sends is kept for it to look at
+struct Datagram {
+	uint8_t ip[4];
+	uint16_t port;
+	Bytes data;
+};
+
+class LoopbackTransport : public AgentuinoTransport {
+public:
+	std::deque<Datagram> inbox, outbox;
+	bool refuse;		// send() fails, like a link that is down
+
+	LoopbackTransport() : refuse(false), _pos(0) {}
+	SNMP_API_STAT_CODES begin(uint16_t port) { (void) port; return SNMP_API_STAT_SUCCESS; }
+	int parsePacket(void) {
+		if ( inbox.empty() ) return 0;
+		_current = inbox.front();
+		inbox.pop_front();
+		_pos = 0;
+		return _current.data.size();
+	}
+	int read(byte *buffer, size_t len) {
+		size_t n = _current.data.size() - _pos;
+
+		if ( n > len ) n = len;
+		memcpy(buffer, _current.data.data() + _pos, n);
+		_pos += n;
+		return n;
+	}
+	void remote(uint8_t *ip, uint16_t *port) {
+		memcpy(ip, _current.ip, 4);
+		*port = _current.port;
+	}
+	SNMP_API_STAT_CODES send(const uint8_t *ip, uint16_t port, const byte *buffer, size_t len) {
+		Datagram d;
+
+		if ( refuse ) return SNMP_API_STAT_SOCKET_ERR;
+		memcpy(d.ip, ip, 4);
+		d.port = port;
+		d.data.assign(buffer, buffer + len);
+		outbox.push_back(d);
+		return SNMP_API_STAT_SUCCESS;
+	}
+	void localIP(uint8_t *ip) {
+		static const uint8_t local[4] = { 192, 0, 2, 1 };
+		memcpy(ip, local, 4);
+	}
+	void receive(const Bytes &data, uint16_t port = 50000) {
+		Datagram d = { { 127, 0, 0, 1 }, port, data };
+		inbox.push_back(d);
+	}
+
+private:
+	Datagram _current;
+	size_t _pos;
+};
+
+static uint8_t nms[4] = { 127, 0, 0, 1 };
+
+static void setUp(AgentuinoClass *agent, LoopbackTransport *transport)
+{
+	agent->setTransport(transport);
+	CHECK(agent->begin("public", "private", "public", 4, nms, 161) == SNMP_API_STAT_SUCCESS);
+}
+
+// hands a request to the agent and decodes its answer
+static Message exchange(AgentuinoClass *agent, LoopbackTransport *transport, const Bytes &request,
+			uint16_t port = 50000)
+{
+	Message m;
+
+	transport->outbox.clear();
+	transport->receive(request, port);
+	agent->listen();
+	if ( transport->outbox.size() != 1 ) {
+		m.ok = false;
+		return m;
+	}
+	return decode(transport->outbox.front().data);
+}
+
+//
+// MIB used by the request tests
+typedef SNMP_OID_LITERAL<1,3,6,1,2,1,1,1,0> sysDescr;
+typedef SNMP_OID_LITERAL<1,3,6,1,2,1,1,5,0> sysName;
+typedef SNMP_OID_LITERAL<1,3,6,1,2,1,1,7,0> sysServices;
+typedef SNMP_OID_LITERAL<1,3,6,1,4,1,36582,1> longString;
+typedef SNMP_OID_LITERAL<1,3,6,1,4,1,36582,2,1> int0;
+typedef SNMP_OID_LITERAL<1,3,6,1,4,1,36582,2,2> int127;
+typedef SNMP_OID_LITERAL<1,3,6,1,4,1,36582,2,3> int128;
+typedef SNMP_OID_LITERAL<1,3,6,1,4,1,36582,2,4> intMinus1;
+typedef SNMP_OID_LITERAL<1,3,6,1,4,1,36582,2,5> intMinus129;
+typedef SNMP_OID_LITERAL<1,3,6,1,4,1,36582,2,6> gaugeMax;
+typedef SNMP_OID_LITERAL<1,3,6,1,4,1,36582,2,7> counter64;
+typedef SNMP_OID_LITERAL<1,3,6,1,4,1,36582,3> slowValue;
+typedef SNMP_OID_LITERAL<1,3,6,1,4,1,36582,4> setCounter;
+typedef SNMP_OID_LITERAL<1,3,6,1,4,1,36582,5,1> portEntry;
+
+static char descr[] = "Agentuino loopback test";
+static char name[20] = "agent";
+static int32_t services = 6;
+static char longText[201];
+static int32_t ints[5] = { 0, 127, 128, -1, -129 };
+static uint32_t gauge = 0xFFFFFFFF;
+static uint64_t big = 0x8000000000000000ULL;
+static int slowReads = 0, sets = 0;
+
+static SNMP_ERR_CODES readSlow(SNMP_VALUE *value)
+{
+	slowReads++;
+	return value->encode(SNMP_SYNTAX_GAUGE, (uint32_t) 42);
+}
+
+static SNMP_ERR_CODES readSets(SNMP_VALUE *value)
+{
+	return value->encode(SNMP_SYNTAX_INT, (int32_t) sets);
+}
+
+static SNMP_ERR_CODES writeSets(SNMP_VALUE *value)
+{
+	(void) value;
+	sets++;
+	return SNMP_ERR_NO_ERROR;
+}
+
+struct Port {
+	char alias[8];
+	uint32_t speed;
+};
+
+static Port ports[2] = { { "up", 100 }, { "down", 1000 } };
+static const SNMP_TABLE_COLUMN portColumns[] = {
+	{ 2, SNMP_SYNTAX_OCTETS, SNMP_ACCESS_READ_WRITE, offsetof(Port, alias), sizeof(ports[0].alias) },
+	{ 3, SNMP_SYNTAX_GAUGE, SNMP_ACCESS_READ_ONLY, offsetof(Port, speed), 0 }
+};
+static AgentuinoTable portTable;
+
+static void addObjects(AgentuinoClass *agent)
+{
+	memset(longText, 'x', sizeof(longText) - 1);
+	// deliberately out of order, the registry sorts them
+	agent->addObject(sysServices::data, sysServices::size, SNMP_SYNTAX_INT, SNMP_ACCESS_STATIC, &services);
+	agent->addObject(sysName::data, sysName::size, SNMP_SYNTAX_OCTETS, SNMP_ACCESS_READ_WRITE, name, sizeof(name));
+	agent->addObject(sysDescr::data, sysDescr::size, SNMP_SYNTAX_OCTETS, SNMP_ACCESS_STATIC, descr);
+	agent->addObject(longString::data, longString::size, SNMP_SYNTAX_OCTETS, SNMP_ACCESS_READ_ONLY, longText);
+	agent->addObject(int0::data, int0::size, SNMP_SYNTAX_INT, SNMP_ACCESS_READ_ONLY, ints + 0);
+	agent->addObject(int127::data, int127::size, SNMP_SYNTAX_INT, SNMP_ACCESS_READ_ONLY, ints + 1);
+	agent->addObject(int128::data, int128::size, SNMP_SYNTAX_INT, SNMP_ACCESS_READ_ONLY, ints + 2);
+	agent->addObject(intMinus1::data, intMinus1::size, SNMP_SYNTAX_INT, SNMP_ACCESS_READ_ONLY, ints + 3);
+	agent->addObject(intMinus129::data, intMinus129::size, SNMP_SYNTAX_INT, SNMP_ACCESS_READ_ONLY, ints + 4);
+	agent->addObject(gaugeMax::data, gaugeMax::size, SNMP_SYNTAX_GAUGE, SNMP_ACCESS_READ_ONLY, &gauge);
+	agent->addObject(counter64::data, counter64::size, SNMP_SYNTAX_COUNTER64, SNMP_ACCESS_READ_ONLY, &big);
+	agent->addObject(slowValue::data, slowValue::size, SNMP_SYNTAX_GAUGE, SNMP_ACCESS_READ_ONLY, readSlow);
+	agent->addObject(setCounter::data, setCounter::size, SNMP_SYNTAX_INT, SNMP_ACCESS_READ_WRITE, readSets, writeSets);
+	portTable.begin(portColumns, 2);
+	for ( uint32_t i = 0; i < 2; i++ ) {
+		uint32_t index = i + 1;
+		portTable.addRow(&index, 1, ports + i);
+	}
+	agent->addTable(portEntry::data, portEntry::size, &portTable);
+}
+
+#define SYS(n)		oid({ 1, 3, 6, 1, 2, 1, 1, n, 0 })
+#define PRIVATE(...)	oid({ 1, 3, 6, 1, 4, 1, 36582, __VA_ARGS__ })
+
+// the whole response, byte for byte, including long-form lengths
+static void testEncoding(AgentuinoClass *agent, LoopbackTransport *transport)
+{
+	Bytes expected = message(SNMP_VERSION_1, "public", SNMP_PDU_RESPONSE, 7, 0, 0,
+		cat(varBind(SYS(1), tlv(SNMP_SYNTAX_OCTETS, str(descr))),
+		    varBind(SYS(7), integer(6))));
+	Message m;
+
+	transport->receive(message(SNMP_VERSION_1, "public", SNMP_PDU_GET, 7, 0, 0,
+				   cat(varBind(SYS(1), null()), varBind(SYS(7), null()))));
+	transport->outbox.clear();
+	agent->listen();
+	CHECK(transport->outbox.size() == 1);
+	CHECK(transport->outbox.size() == 1 && transport->outbox.front().data == expected);
+
+	m = exchange(agent, transport, message(SNMP_VERSION_1, "public", SNMP_PDU_GET, 8, 0, 0,
+					       varBind(PRIVATE(1), null())));
+	CHECK(m.ok && m.varBinds.size() == 1 && m.varBinds[0].value == str(longText));
+	CHECK(transport->outbox.front().data
+	      == message(SNMP_VERSION_1, "public", SNMP_PDU_RESPONSE, 8, 0, 0,
+			 varBind(PRIVATE(1), tlv(SNMP_SYNTAX_OCTETS, str(longText)))));
+
+	// minimal integers
+	m = exchange(agent, transport, message(SNMP_VERSION_2C, "public", SNMP_PDU_GET, 9, 0, 0,
+		cat(cat(cat(varBind(PRIVATE(2, 1), null()), varBind(PRIVATE(2, 2), null())),
+			cat(varBind(PRIVATE(2, 3), null()), varBind(PRIVATE(2, 4), null()))),
+		    cat(cat(varBind(PRIVATE(2, 5), null()), varBind(PRIVATE(2, 6), null())),
+			varBind(PRIVATE(2, 7), null())))));
+	CHECK(m.ok && m.error == 0 && m.varBinds.size() == 7);
+	if ( m.varBinds.size() == 7 ) {
+		for ( int i = 0; i < 5; i++ ) {
+			CHECK(tlv(m.varBinds[i].type, m.varBinds[i].value) == integer(ints[i]));
+		}
+		CHECK(tlv(m.varBinds[5].type, m.varBinds[5].value) == unsignedInt(gauge, SNMP_SYNTAX_GAUGE));
+		CHECK(tlv(m.varBinds[6].type, m.varBinds[6].value) == unsignedInt(big, SNMP_SYNTAX_COUNTER64));
+	}
+}
+
+// GET-NEXT walks the registry in OID order whatever order objects were added in
+static void testWalk(AgentuinoClass *agent, LoopbackTransport *transport)
+{
+	Bytes order[] = { oidBytes({ 1, 3, 6, 1, 2, 1, 1, 1, 0 }), oidBytes({ 1, 3, 6, 1, 2, 1, 1, 5, 0 }),
+			  oidBytes({ 1, 3, 6, 1, 2, 1, 1, 7, 0 }), oidBytes({ 1, 3, 6, 1, 4, 1, 36582, 1 }) };
+	Bytes next = oidBytes({ 1, 3, 6, 1, 2, 1 });
+	Message m;
+
+	for ( size_t i = 0; i < sizeof(order) / sizeof(order[0]); i++ ) {
+		m = exchange(agent, transport, message(SNMP_VERSION_1, "public", SNMP_PDU_GET_NEXT, 10 + i, 0, 0,
+						       varBind(tlv(SNMP_SYNTAX_OID, next), null())));
+		CHECK(m.ok && m.varBinds.size() == 1 && m.varBinds[0].oid == order[i]);
+		if ( !m.ok || m.varBinds.empty() ) return;
+		next = m.varBinds[0].oid;
+	}
+	// the end of the MIB: noSuchName in v1, endOfMibView in v2c
+	m = exchange(agent, transport, message(SNMP_VERSION_1, "public", SNMP_PDU_GET_NEXT, 20, 0, 0,
+					       varBind(PRIVATE(9), null())));
+	CHECK(m.ok && m.error == SNMP_ERR_NO_SUCH_NAME && m.errorIndex == 1);
+	m = exchange(agent, transport, message(SNMP_VERSION_2C, "public", SNMP_PDU_GET_NEXT, 21, 0, 0,
+					       varBind(PRIVATE(9), null())));
+	CHECK(m.ok && m.error == 0 && m.varBinds.size() == 1
+	      && m.varBinds[0].type == SNMP_SYNTAX_END_OF_MIB_VIEW);
+}
+
+// a SET is applied completely or not at all, table bindings included
+static void testSet(AgentuinoClass *agent, LoopbackTransport *transport)
+{
+	Message m;
+
+	m = exchange(agent, transport, message(SNMP_VERSION_2C, "private", SNMP_PDU_SET, 30, 0, 0,
+		cat(varBind(SYS(5), tlv(SNMP_SYNTAX_OCTETS, str("renamed"))),
+		    varBind(PRIVATE(5, 1, 3, 1), unsignedInt(1, SNMP_SYNTAX_GAUGE)))));
+	CHECK(m.ok && m.error == SNMP_ERR_NOT_WRITABLE && m.errorIndex == 2);
+	CHECK(strcmp(name, "agent") == 0);
+
+	m = exchange(agent, transport, message(SNMP_VERSION_2C, "private", SNMP_PDU_SET, 31, 0, 0,
+		cat(varBind(SYS(5), tlv(SNMP_SYNTAX_OCTETS, str("renamed"))),
+		    varBind(PRIVATE(5, 1, 2, 2), tlv(SNMP_SYNTAX_OCTETS, str("far too long"))))));
+	CHECK(m.ok && m.error == SNMP_ERR_WRONG_LENGTH && m.errorIndex == 2);
+	CHECK(strcmp(name, "agent") == 0);
+
+	m = exchange(agent, transport, message(SNMP_VERSION_2C, "private", SNMP_PDU_SET, 32, 0, 0,
+		cat(varBind(SYS(5), tlv(SNMP_SYNTAX_OCTETS, str("renamed"))),
+		    varBind(PRIVATE(5, 1, 2, 9), tlv(SNMP_SYNTAX_OCTETS, str("x"))))));
+	CHECK(m.ok && m.error == SNMP_ERR_NO_CREATION && m.errorIndex == 2);
+	CHECK(strcmp(name, "agent") == 0);
+
+	m = exchange(agent, transport, message(SNMP_VERSION_2C, "private", SNMP_PDU_SET, 33, 0, 0,
+		cat(varBind(SYS(5), tlv(SNMP_SYNTAX_OCTETS, str("renamed"))),
+		    varBind(PRIVATE(5, 1, 2, 2), tlv(SNMP_SYNTAX_OCTETS, str("wan"))))));
+	CHECK(m.ok && m.error == 0);
+	CHECK(strcmp(name, "renamed") == 0 && strcmp(ports[1].alias, "wan") == 0);
+}
+
+// GETBULK: non-repeaters, repetitions and no redundant endOfMibView rows
+static void testBulk(AgentuinoClass *agent, LoopbackTransport *transport)
+{
+	Message m;
+
+	// sysDescr once, then three repetitions of the alias column
+	m = exchange(agent, transport, message(SNMP_VERSION_2C, "public", SNMP_PDU_GET_BULK, 40, 1, 3,
+		cat(varBind(SYS(1), null()), varBind(PRIVATE(5, 1, 2), null()))));
+	CHECK(m.ok && m.error == 0 && m.varBinds.size() == 4);
+	if ( m.varBinds.size() == 4 ) {
+		CHECK(m.varBinds[0].oid == oidBytes({ 1, 3, 6, 1, 2, 1, 1, 5, 0 }));
+		CHECK(m.varBinds[1].oid == oidBytes({ 1, 3, 6, 1, 4, 1, 36582, 5, 1, 2, 1 }));
+		CHECK(m.varBinds[2].oid == oidBytes({ 1, 3, 6, 1, 4, 1, 36582, 5, 1, 2, 2 }));
+		CHECK(m.varBinds[3].oid == oidBytes({ 1, 3, 6, 1, 4, 1, 36582, 5, 1, 3, 1 }));
+	}
+	// the first repetition is already at the end of the MIB
+	m = exchange(agent, transport, message(SNMP_VERSION_2C, "public", SNMP_PDU_GET_BULK, 41, 0, 5,
+					       varBind(PRIVATE(9), null())));
+	CHECK(m.ok && m.varBinds.size() == 1 && m.varBinds[0].type == SNMP_SYNTAX_END_OF_MIB_VIEW);
+	// the end is reached in the second one, which is the last
+	m = exchange(agent, transport, message(SNMP_VERSION_2C, "public", SNMP_PDU_GET_BULK, 42, 0, 5,
+					       varBind(PRIVATE(5, 1, 3, 1), null())));
+	CHECK(m.ok && m.varBinds.size() == 2 && m.varBinds[1].type == SNMP_SYNTAX_END_OF_MIB_VIEW);
+}
+
+// retransmissions are answered from the response cache, slow getters from the value cache
+static void testCaches(AgentuinoClass *agent, LoopbackTransport *transport)
+{
+	Bytes set = message(SNMP_VERSION_2C, "private", SNMP_PDU_SET, 50, 0, 0,
+			    varBind(PRIVATE(4), integer(1)));
+	Bytes first, second;
+	uint32_t hits = agent->responseCacheHits();
+
+	exchange(agent, transport, set);
+	first = transport->outbox.empty() ? Bytes() : transport->outbox.front().data;
+	exchange(agent, transport, set);
+	second = transport->outbox.empty() ? Bytes() : transport->outbox.front().data;
+	CHECK(sets == 1 && !first.empty() && first == second);
+	CHECK(agent->responseCacheHits() == hits + 1);
+	// the same request-id from another port is a different request
+	exchange(agent, transport, set, 50001);
+	CHECK(sets == 2);
+
+	CHECK(agent->setObjectTtl(slowValue::data, slowValue::size, 10000) == SNMP_API_STAT_SUCCESS);
+	exchange(agent, transport, message(SNMP_VERSION_2C, "public", SNMP_PDU_GET, 51, 0, 0, varBind(PRIVATE(3), null())));
+	exchange(agent, transport, message(SNMP_VERSION_2C, "public", SNMP_PDU_GET, 52, 0, 0, varBind(PRIVATE(3), null())));
+	CHECK(slowReads == 1 && agent->valueCacheHits() == 1);
+}
+
+//
+// Notifications
+typedef SNMP_OID_LITERAL<1,3,6,1,4,1,36582,9> enterprise;
+static uint32_t watched = 0, threshold = 10;
+
+// an inform is retransmitted until a matching Response acknowledges it
+static void testInform(void)
+{
+	LoopbackTransport transport;
+	AgentuinoClass agent;
+	Message inform;
+	Bytes ack;
+
+	setUp(&agent, &transport);
+	CHECK(agent.addTrapTarget(nms, 1162, "informs", SNMP_PDU_INFORM) == SNMP_API_STAT_SUCCESS);
+	agent.setInformTimeout(20, 3);
+	CHECK(agent.installTrap(enterprise::data, enterprise::size, SNMP_TRAP_ENTERPRISE_SPECIFIC, 1,
+				&watched, SNMP_SYNTAX_GAUGE, GREATER_THAN, &threshold, NULL, SNMP_TRAP_EDGE) == 0);
+	watched = 11;
+	agent.trapWatcher();
+	CHECK(transport.outbox.size() == 1 && agent.pendingInforms() == 1);
+	if ( transport.outbox.size() != 1 ) return;
+	CHECK(transport.outbox.front().port == 1162);
+	inform = decode(transport.outbox.front().data);
+	CHECK(inform.ok && inform.type == SNMP_PDU_INFORM && inform.community == str("informs"));
+	// sysUpTime.0, snmpTrapOID.0 = enterprise.0.1
+	CHECK(inform.varBinds.size() == 2);
+	if ( inform.varBinds.size() == 2 ) {
+		CHECK(inform.varBinds[1].value == oidBytes({ 1, 3, 6, 1, 4, 1, 36582, 9, 0, 1 }));
+	}
+
+	// wrong community, an error status or another port do not acknowledge it
+	transport.outbox.clear();
+	transport.receive(message(SNMP_VERSION_2C, "public", SNMP_PDU_RESPONSE, inform.requestId, 0, 0, Bytes()), 1162);
+	transport.receive(message(SNMP_VERSION_2C, "informs", SNMP_PDU_RESPONSE, inform.requestId, 5, 1, Bytes()), 1162);
+	transport.receive(message(SNMP_VERSION_2C, "informs", SNMP_PDU_RESPONSE, inform.requestId, 0, 0, Bytes()), 1163);
+	agent.setListenBudget(3);
+	agent.listen();
+	CHECK(agent.pendingInforms() == 1 && agent.informsAcked() == 0);
+
+	// retransmitted with the same request-id after the timeout
+	transport.outbox.clear();
+	delay(30);
+	agent.flushTraps();
+	CHECK(transport.outbox.size() == 1);
+	if ( transport.outbox.size() == 1 ) {
+		CHECK(decode(transport.outbox.front().data).requestId == inform.requestId);
+	}
+
+	transport.receive(message(SNMP_VERSION_2C, "informs", SNMP_PDU_RESPONSE, inform.requestId, 0, 0, Bytes()), 1162);
+	agent.listen();
+	CHECK(agent.pendingInforms() == 0 && agent.informsAcked() == 1);
+	watched = 0;
+}
+
+// text binding OIDs are encoded into the trap, the caller's list stays text
+static void testTrapBindings(void)
+{
+	LoopbackTransport transport;
+	AgentuinoClass agent;
+	VAR_BIND_LIST head, node;
+	Message trap;
+
+	setUp(&agent, &transport);
+	memset(&head, 0, sizeof(head));
+	memset(&node, 0, sizeof(node));
+	strcpy(node.oid, "1.3.6.1.2.1.1.5.0");
+	node.var = name;
+	node.type = SNMP_SYNTAX_OCTETS;
+	head.nextVar = &node;
+	CHECK(agent.installTrap("1.3.6.1.4.1.36582.9", SNMP_TRAP_ENTERPRISE_SPECIFIC, 2, &watched,
+				SNMP_SYNTAX_GAUGE, GREATER_THAN, &threshold, &head, SNMP_TRAP_EDGE) == 0);
+	CHECK(strcmp(node.oid, "1.3.6.1.2.1.1.5.0") == 0 && node.berOid == NULL);
+	watched = 11;
+	agent.trapWatcher();
+	CHECK(transport.outbox.size() == 1 && transport.outbox.front().port == 162);
+	if ( transport.outbox.size() != 1 ) return;
+	trap = decode(transport.outbox.front().data);
+	CHECK(trap.ok && trap.type == SNMP_PDU_TRAP && trap.specific == 2);
+	CHECK(trap.enterprise == oidBytes({ 1, 3, 6, 1, 4, 1, 36582, 9 }));
+	CHECK(trap.varBinds.size() == 1);
+	if ( trap.varBinds.size() == 1 ) {
+		CHECK(trap.varBinds[0].oid == oidBytes({ 1, 3, 6, 1, 2, 1, 1, 5, 0 }));
+		CHECK(trap.varBinds[0].value == str(name));
+	}
+	watched = 0;
+}
+
+// traps the transport refuses are queued in a file and sent by the next agent
+static void testTrapQueueFile(void)
+{
+	char path[] = "/tmp/agentuino-loopback-XXXXXX";
+	char tooLong[SNMP_TRAP_FILE_LEN];
+	int fd = mkstemp(path);
+
+	CHECK(fd >= 0);
+	if ( fd < 0 ) return;
+	close(fd);
+	{
+		LoopbackTransport transport;
+		AgentuinoClass agent;
+
+		setUp(&agent, &transport);
+		transport.refuse = true;
+		CHECK(agent.setTrapQueueFile(path) == SNMP_API_STAT_SUCCESS);
+		agent.installTrap(enterprise::data, enterprise::size, SNMP_TRAP_ENTERPRISE_SPECIFIC, 3,
+				  &watched, SNMP_SYNTAX_GAUGE, GREATER_THAN, &threshold, NULL);
+		watched = 11;
+		agent.trapWatcher();
+		agent.trapWatcher();
+		CHECK(agent.pendingTraps() == 2);
+		watched = 0;
+	}
+	{
+		LoopbackTransport transport;
+		AgentuinoClass agent;
+
+		setUp(&agent, &transport);
+		CHECK(agent.setTrapQueueFile(path) == SNMP_API_STAT_SUCCESS);
+		CHECK(agent.pendingTraps() == 2);
+		// loading again does not queue the traps twice
+		CHECK(agent.setTrapQueueFile(path) == SNMP_API_STAT_SUCCESS);
+		CHECK(agent.pendingTraps() == 2);
+		CHECK(agent.flushTraps() == 0 && transport.outbox.size() == 2);
+		if ( transport.outbox.size() == 2 ) {
+			CHECK(decode(transport.outbox.front().data).specific == 3);
+		}
+	}
+	{
+		AgentuinoClass agent;
+
+		memset(tooLong, 'a', sizeof(tooLong) - 1);
+		tooLong[0] = '/';
+		tooLong[sizeof(tooLong) - 1] = '\0';
+		CHECK(agent.setTrapQueueFile(tooLong) == SNMP_API_STAT_NAME_TOO_BIG);
+	}
+	unlink(path);
+}
+
+// COUNTER64 measures compare unsigned, also past 2^63
+static void testCounter64Measure(void)
+{
+	LoopbackTransport transport;
+	AgentuinoClass agent;
+	uint64_t value = 0, maxThreshold = 0xF000000000000000ULL, avgThreshold = 0xE000000000000000ULL;
+
+	setUp(&agent, &transport);
+	CHECK(agent.installTrap(enterprise::data, enterprise::size, SNMP_TRAP_ENTERPRISE_SPECIFIC, 4,
+				&value, SNMP_SYNTAX_COUNTER64, GREATER_THAN, &maxThreshold, NULL,
+				SNMP_TRAP_LEVEL, NULL, 0, SNMP_TRAP_MAX, 2) == 0);
+	CHECK(agent.installTrap(enterprise::data, enterprise::size, SNMP_TRAP_ENTERPRISE_SPECIFIC, 5,
+				&value, SNMP_SYNTAX_COUNTER64, GREATER_THAN, &avgThreshold, NULL,
+				SNMP_TRAP_LEVEL, NULL, 0, SNMP_TRAP_AVERAGE, 2) == 0);
+	value = 0xFFFFFFFFFFFFFF00ULL;
+	CHECK(agent.trapWatcher() == 2);
+	value = 0xF800000000000000ULL;
+	CHECK(agent.trapWatcher() == 2);	// max 0xFF.., average 0xFB..
+	value = 0x100;
+	CHECK(agent.trapWatcher() == 1);	// max 0xF8.., average 0x7C..
+}
+
+// listen() before begin() has nothing to read from
+static void testNoTransport(void)
+{
+	AgentuinoClass agent;
+
+	agent.listen();
+	CHECK(agent.processReady() == 0);
+}
+
+#if defined(__linux__)
+static int ticks = 0;
+
+static void tick(void *)
+{
+	ticks++;
+}
+
+// periods missed while the loop was busy do not run the timer in a burst
+static void testTimerStall(void)
+{
+	AgentuinoEventLoop loop;
+
+	CHECK(loop.addTimer(10, tick) == SNMP_API_STAT_SUCCESS);
+	delay(60);
+	loop.runOnce(1000);
+	CHECK(ticks == 1);
+}
+
+// a worker pool over real UDP sockets: every request is answered, the
+// counters the workers publish add up, and the port stays the pool's
+static void testWorkers(void)
+{
+	const uint16_t port = 16161;
+	const int requests = 16;
+	AgentuinoClass registry;
+	AgentuinoWorkers pool;
+	AgentuinoPosix intruder;
+	struct sockaddr_in to;
+	struct timeval timeout = { 1, 0 };
+	uint32_t handled = 0;
+	int answered = 0;
+	int fd;
+
+	registry.addObject(sysDescr::data, sysDescr::size, SNMP_SYNTAX_OCTETS, SNMP_ACCESS_STATIC, descr);
+	CHECK(pool.begin(&registry, 2, port, "public", "private") == SNMP_API_STAT_SUCCESS);
+	if ( pool.count() != 2 ) return;
+	CHECK(intruder.begin(port) == SNMP_API_STAT_SOCKET_ERR);
+
+	fd = socket(AF_INET, SOCK_DGRAM, 0);
+	setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	memset(&to, 0, sizeof(to));
+	to.sin_family = AF_INET;
+	to.sin_port = htons(port);
+	to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	for ( int i = 0; i < requests; i++ ) {
+		Bytes request = message(SNMP_VERSION_1, "public", SNMP_PDU_GET, 60 + i, 0, 0, varBind(SYS(1), null()));
+		sendto(fd, request.data(), request.size(), 0, (struct sockaddr *) &to, sizeof(to));
+	}
+	for ( int i = 0; i < requests; i++ ) {
+		Bytes response(SNMP_MAX_PACKET_LEN);
+		ssize_t n = recv(fd, response.data(), response.size(), 0);
+
+		if ( n <= 0 ) break;
+		response.resize(n);
+		Message m = decode(response);
+		if ( m.ok && m.error == 0 && m.varBinds.size() == 1 && m.varBinds[0].value == str(descr) ) {
+			answered++;
+		}
+	}
+	close(fd);
+	CHECK(answered == requests);
+	// counters are published after each batch; give the workers a poll or two
+	delay(250);
+	for ( uint8_t i = 0; i < pool.count(); i++ ) {
+		handled += pool.stats(i).requests;
+	}
+	CHECK(handled == (uint32_t) requests);
+	pool.stop();
+}
+#endif
+
+int main(void)
+{
+	LoopbackTransport transport;
+	AgentuinoClass agent;
+
+	setUp(&agent, &transport);
+	addObjects(&agent);
+	testEncoding(&agent, &transport);
+	testWalk(&agent, &transport);
+	testSet(&agent, &transport);
+	testBulk(&agent, &transport);
+	testCaches(&agent, &transport);
+	testInform();
+	testTrapBindings();
+	testTrapQueueFile();
+	testCounter64Measure();
+	testNoTransport();
+#if defined(__linux__)
+	testTimerStall();
+	testWorkers();
+#endif
+	printf("%d failure(s)\n", failures);
+	return failures ? 1 : 0;
+}